@@ -1,10 +1,21 @@
+#define _GNU_SOURCE     // accept4()
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <string.h>
 #include <unistd.h>
 #include <ctype.h>
 #include <limits.h>
+#include <errno.h>
+#include <pthread.h>
+#include <signal.h>
+#include <time.h>
+#include <arpa/inet.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
 
 /* editDistance.c
  *
@@ -22,9 +33,6 @@
 // The longest word we would expect to see in the English Input
 #define MAX_WORD_LENGTH 256
 
-// The largest increase in size we would expect to see from a minimum Edit
-#define EXPANSION_FACTOR 2
-
 
 // Hash table data
 // The number of length-based buckets -- based on the longest word in our dataset
@@ -33,10 +41,32 @@
 // A node in our hash table
 typedef struct node {
     char* word;
-    struct node *L, *R, *N; // Left, Right tree data and N is for storing minima
+    struct node *L, *R;     // Left, Right tree data
+    struct node *D;         // The next word of the same spelling (the dictionary may repeat words once lowercased)
+    int order;              // Position in a full traversal of the table, which decides the order minima are listed in
+    unsigned long frequency; // How common the word is, from the dictionary's optional second column (0 if none)
 } node_t;
 
 
+// Trie data
+// A node of the dictionary trie. The children of a node form a list through their sibling indices, and
+// nodes are kept in one growing array so that the search walks contiguous memory.
+typedef struct trienode {
+    int child;              // Index of the first child (-1 if none)
+    int sibling;            // Index of the next sibling (-1 if none)
+    char symbol;            // The character on the edge into this node
+    node_t *word;           // The dictionary word spelled out by the path to this node (NULL if none)
+} trienode_t;
+
+// The trie itself; node 0 is the root (the empty prefix)
+typedef struct trie {
+    trienode_t *nodes;
+    int count;
+    int allocated;
+    int depth;              // The length of the longest word
+} trie_t;
+
+
 // Hash function
 int hash(char* str){
     return ((strlen(str) << 4) + str[0]) % HASH_BUCKETS;
@@ -44,7 +74,8 @@ int hash(char* str){
 
 
 // Add a node to the hash table
-void addNode(char *str, node_t **table){
+// Returns the new node
+node_t *addNode(char *str, node_t **table){
     int index = hash(str);
     node_t* cur = table[index];
     node_t** backPointer = &(table[index]);
@@ -61,8 +92,23 @@ void addNode(char *str, node_t **table){
     *backPointer = (node_t*)malloc(sizeof(node_t));
     (*backPointer)->L = NULL;
     (*backPointer)->R = NULL;
-    (*backPointer)->N = NULL;
+    (*backPointer)->D = NULL;
+    (*backPointer)->order = 0;
+    (*backPointer)->frequency = 0;
     (*backPointer)->word = strdup(str);
+    return *backPointer;
+}
+
+
+// Number the nodes of a bucket-tree in post-order (left, right, then the node), the order in which a full search
+// of the table meets them
+int orderNodes(node_t *cur, int next){
+    if (cur != NULL){
+        next = orderNodes(cur->L, next);
+        next = orderNodes(cur->R, next);
+        cur->order = next++;
+    }
+    return next;
 }
 
 
@@ -88,6 +134,58 @@ bool contains(char *str, node_t **table){
 
 
 
+// Trie functionality
+// Make an empty trie, holding only its root
+void initTrie(trie_t *trie){
+    trie->allocated = 1024;
+    trie->nodes = malloc(sizeof(trienode_t) * trie->allocated);
+    trie->nodes[0].child = -1;
+    trie->nodes[0].sibling = -1;
+    trie->nodes[0].symbol = '\0';
+    trie->nodes[0].word = NULL;
+    trie->count = 1;
+    trie->depth = 0;
+}
+
+
+// Add the word held by a hash table node to the trie, sharing the path of every prefix it has in common
+// with the words already there
+void addTrieWord(trie_t *trie, node_t *word){
+    int cur = 0;
+    int len = strlen(word->word);
+    for(int i = 0; i < len; i++){
+        // Seek the child on this character, appending it if it is new
+        int c = trie->nodes[cur].child;
+        while(c != -1 && trie->nodes[c].symbol != word->word[i]) c = trie->nodes[c].sibling;
+        if(c == -1){
+            if(trie->count == trie->allocated){
+                trie->allocated *= 2;
+                trie->nodes = realloc(trie->nodes, sizeof(trienode_t) * trie->allocated);
+            }
+            c = trie->count++;
+            trie->nodes[c].child = -1;
+            trie->nodes[c].sibling = trie->nodes[cur].child;
+            trie->nodes[c].symbol = word->word[i];
+            trie->nodes[c].word = NULL;
+            trie->nodes[cur].child = c;
+        }
+        cur = c;
+    }
+    // Repeated spellings hang off the first
+    if(trie->nodes[cur].word == NULL){
+        trie->nodes[cur].word = word;
+    } else {
+        node_t *last = trie->nodes[cur].word;
+        while(last->D != NULL) last = last->D;
+        last->D = word;
+    }
+    if(len > trie->depth) trie->depth = len;
+}
+
+
+
+
+
 // editDistance
 // Returns the Levenshtein distance between strings s1 and s2
 // If silent is true, prints nothing. Otherwise, it prints the Dynamic Program Memo table
@@ -163,39 +261,878 @@ int editDistance(char* s1, char* s2, bool silent){
 
 
 
+// A word found near a string
+typedef struct candidate {
+    node_t *word;
+    int distance;
+} candidate_t;
+
+// The words found nearest a string. By default these are all of the words at the least distance; given a limit k,
+// they are the k best words at any distance, kept as a max-heap with the worst at its root while searching. Either
+// way they end up ranked best first: by distance, then by frequency, and then in the order a traversal of the whole
+// hash table would have listed them (last-found first, as the old linked list of minima ran).
+// Each search fills its own, so that any number of threads may search the dictionary at once.
+typedef struct candidates {
+    candidate_t *words;
+    int count;
+    int allocated;
+    int limit;              // The most words to find (0 for every word at the least distance)
+    int distance;           // No word further than this is wanted: the least distance found so far, or with a
+                            // limit the distance of the worst word kept once there are limit of them (else INT_MAX)
+} candidates_t;
+
+
+// Ranks candidates: negative if a is the better suggestion, positive if b is
+int compareCandidates(const void *a, const void *b){
+    const candidate_t *x = (const candidate_t*)a, *y = (const candidate_t*)b;
+    if(x->distance != y->distance) return (x->distance < y->distance) ? -1 : 1;
+    if(x->word->frequency != y->word->frequency) return (x->word->frequency > y->word->frequency) ? -1 : 1;
+    return y->word->order - x->word->order;
+}
+
+
+// Offer a word to a limited list of candidates, which keeps it in place of its worst if it ranks better
+void offerCandidate(candidates_t *found, candidate_t offer){
+    candidate_t *heap = found->words;
+    int i;
+    if(found->count < found->limit){
+        // Sift the new word up from the bottom of the heap
+        i = found->count++;
+        while(i > 0 && compareCandidates(&offer, &heap[(i - 1) / 2]) > 0){
+            heap[i] = heap[(i - 1) / 2];
+            i = (i - 1) / 2;
+        }
+    } else if(compareCandidates(&offer, &heap[0]) < 0){
+        // Replace the worst word, sifting the new one down from the root
+        i = 0;
+        while(true){
+            int worse = 2 * i + 1;
+            if(worse >= found->count) break;
+            if(worse + 1 < found->count && compareCandidates(&heap[worse + 1], &heap[worse]) > 0) worse++;
+            if(compareCandidates(&heap[worse], &offer) <= 0) break;
+            heap[i] = heap[worse];
+            i = worse;
+        }
+    } else {
+        return;
+    }
+    heap[i] = offer;
+    if(found->count == found->limit) found->distance = heap[0].distance;
+}
+
+
+// State of one search of the trie for the words nearest each of a set of strings. The trie is walked once for all
+// of them, each trie node's row being computed for every string still looking beneath it while the node is at hand.
+typedef struct trieSearch {
+    trie_t *trie;
+    int strings;            // The number of strings sought
+    char **str;             // The strings sought
+    int *len;               // Their lengths
+    int ***rows;            // rows[s][d] is string s's Dynamic Memo Table row for the trie prefix of length d
+    int **active;           // active[d] lists the strings still looking beneath the trie node at depth d
+    candidates_t *found;    // found[s] holds the words found so far for string s
+} trieSearch_t;
+
+
+// Record the words held by a trie node, at distance dist from a string sought, if they are among the nearest so far
+void recordMinima(candidates_t *found, trienode_t *node, int dist){
+    if(node->word == NULL || dist > found->distance) return;
+    if(found->limit > 0){
+        for(node_t *word = node->word; word != NULL; word = word->D) offerCandidate(found, (candidate_t){word, dist});
+        return;
+    }
+    if(dist < found->distance){
+        // A new minimum has been found. Orphan the old minima and begin anew.
+        found->distance = dist;
+        found->count = 0;
+    }
+    for(node_t *word = node->word; word != NULL; word = word->D){
+        if(found->count == found->allocated){
+            found->allocated *= 2;
+            found->words = realloc(found->words, sizeof(candidate_t) * found->allocated);
+        }
+        found->words[found->count++] = (candidate_t){word, dist};
+    }
+}
+
+
 // Helper for below function
-// Returns length of minimum
-void minEditDistanceKernel(char *str, node_t *cur, int* minDist, node_t** minHead){
-    if (cur != NULL){
-        // Reset minimum data
-        cur->N = NULL;
-        minEditDistanceKernel(str, cur->L, minDist, minHead);
-        minEditDistanceKernel(str, cur->R, minDist, minHead);
-
-        int dist = editDistance(str, cur->word, true);
-        if(dist < (*minDist)){
-            // A new minimum has been found. Orphan the old minima and begin anew.
-            *minDist = dist;
-            *minHead = cur;
-        } else if (dist == (*minDist)){
-            // Prepend this alternative to the current list of minima
-            cur->N = *minHead;
-            *minHead = cur;
+// Computes the Memo Table rows of each child of trie node n (at depth d) from n's rows, for each of the count strings
+// in active[d], recording the words ending there, and descends into every child with the strings whose rows could
+// still lead to a word no further away than their best found so far (or, with a limit, than the worst word kept).
+// Since every entry of a deeper row is at least the smallest entry of the row above it, a string whose row minimum
+// exceeds that distance has no word worth visiting beneath the child, and a child with no such strings is skipped.
+void trieSearchKernel(trieSearch_t *search, int n, int d, int count){
+    for(int c = search->trie->nodes[n].child; c != -1; c = search->trie->nodes[c].sibling){
+        trienode_t *child = &(search->trie->nodes[c]);
+        int stillActive = 0;
+
+        for(int a = 0; a < count; a++){
+            int s = search->active[d][a];
+            int *prevRow = search->rows[s][d];
+            int *curRow = search->rows[s][d + 1];
+            char *str = search->str[s];
+
+            // One row of editDistance()'s Table, with the trie prefix in place of s1
+            *curRow = d + 1;
+            int rowMin = *curRow;
+            for(int j = 0; j < search->len[s]; j++){
+                int costDel = prevRow[j + 1] + 1;
+                int costIns = curRow[j] + 1;
+                int costSub = (child->symbol == str[j]) ? prevRow[j] : prevRow[j] + 1;
+                curRow[j + 1] = (costDel < costIns) ? ((costDel < costSub) ? costDel : costSub) : ((costIns < costSub) ? costIns : costSub);
+                if(curRow[j + 1] < rowMin) rowMin = curRow[j + 1];
+            }
+
+            recordMinima(&(search->found[s]), child, curRow[search->len[s]]);
+
+            if(rowMin <= search->found[s].distance) search->active[d + 1][stillActive++] = s;
+        }
+
+        if(child->child != -1 && stillActive > 0) trieSearchKernel(search, c, d + 1, stillActive);
+    }
+}
+
+
+// Search the dictionary trie for the words with minimum edit distances to each of the count strings given (or, if
+// limit is not 0, the limit best words), filling found[s] with those for string s, best first (free each with
+// freeCandidates()). The trie is walked once, however many strings there are.
+void batchEditDistances(char **strs, int count, trie_t *trie, int limit, candidates_t *found){
+    trieSearch_t search;
+    search.trie = trie;
+    search.strings = count;
+    search.str = strs;
+    search.len = malloc(sizeof(int) * count);
+    search.rows = malloc(sizeof(int**) * count);
+    search.active = malloc(sizeof(int*) * (trie->depth + 1));
+    search.found = found;
+    for(int d = 0; d <= trie->depth; d++) search.active[d] = malloc(sizeof(int) * count);
+
+    for(int s = 0; s < count; s++){
+        found[s].count = 0;
+        found[s].allocated = (limit > 0) ? limit : 16;
+        found[s].words = malloc(sizeof(candidate_t) * found[s].allocated);
+        found[s].limit = limit;
+        found[s].distance = INT_MAX;
+
+        // One row per level of the trie; row 0 holds the cost of reducing each prefix of the string to epsilon
+        search.len[s] = strlen(strs[s]);
+        search.rows[s] = malloc(sizeof(int*) * (trie->depth + 1));
+        for(int d = 0; d <= trie->depth; d++) search.rows[s][d] = malloc(sizeof(int) * (search.len[s] + 1));
+        for(int j = 0; j <= search.len[s]; j++) search.rows[s][0][j] = j;
+        recordMinima(&(found[s]), &(trie->nodes[0]), search.len[s]);   // A blank line of the dictionary is the empty word
+        search.active[0][s] = s;
+    }
+
+    trieSearchKernel(&search, 0, 0, count);
+
+    for(int s = 0; s < count; s++){
+        qsort(found[s].words, found[s].count, sizeof(candidate_t), compareCandidates);
+        for(int d = 0; d <= trie->depth; d++) free(search.rows[s][d]);
+        free(search.rows[s]);
+    }
+    for(int d = 0; d <= trie->depth; d++) free(search.active[d]);
+    free(search.active);
+    free(search.rows);
+    free(search.len);
+}
+
+
+// Search the dictionary trie for the words with minimum edit distances to the indicated string (or, if limit is
+// not 0, the limit best words), filling found with them, best first (free it with freeCandidates()).
+void minimumEditDistances(char *str, trie_t *trie, int limit, candidates_t *found){
+    batchEditDistances(&str, 1, trie, limit, found);
+}
+
+
+void freeCandidates(candidates_t *found){
+    free(found->words);
+}
+
+
+
+
+// Dictionary
+// The loaded dictionary: the hash table answers whether a word is correct, and the trie searches for corrections
+typedef struct dictionary {
+    node_t **table;
+    trie_t trie;
+} dictionary_t;
+
+
+// Read in the entire English Dictionary at path, one word per line, optionally followed by whitespace and the
+// word's frequency (by which suggestions at the same distance are ranked)
+// Returns false (having said why on stderr) if it cannot be read
+bool loadDictionary(const char *path, dictionary_t *dict){
+    // TODO: turn this into a memory-mapped custom data structure for efficient loading
+    FILE *fp = fopen(path, "r");
+    if (fp == NULL){
+        fprintf(stderr, "Couldn't get %s: ", path);
+        perror(NULL);
+        return false;
+    }
+
+    // Make Hash Table, and the Trie through which it is searched for corrections
+    dict->table = calloc(HASH_BUCKETS, sizeof(node_t*));
+    initTrie(&(dict->trie));
+
+    // Iterate over Dictionary
+    char buffer[MAX_WORD_LENGTH];
+    while (fgets(buffer, MAX_WORD_LENGTH, fp)) {
+        int len = strlen(buffer);
+        if (buffer[len - 1] == '\n') buffer[len - 1] = '\0';    // Trim off trailing newline
+        // Split off a frequency column, if the line ends in one
+        unsigned long frequency = 0;
+        char *column = strpbrk(buffer, " \t");
+        if (column != NULL){
+            char *end;
+            frequency = strtoul(column, &end, 10);
+            if (end != column && *end == '\0') *column = '\0';
+            else frequency = 0;
+        }
+        // Convert to Lowercase
+        for(int i = 0; buffer[i]; i++) buffer[i] = tolower(buffer[i]);
+        // Append the word to the Hash Table and the Trie
+        node_t *word = addNode(buffer, dict->table);
+        word->frequency = frequency;
+        addTrieWord(&(dict->trie), word);
+    }
+    fclose(fp);
+    for(int i = 0, next = 0; i < HASH_BUCKETS; i++) next = orderNodes(dict->table[i], next);
+    return true;
+}
+
+
+
+
+// Correction
+// The corrections for every misspelled word of a text, found in a single pass over the dictionary before any of the
+// text is written
+typedef struct corrections {
+    char **tokens;          // The distinct misspelled words of the text, lowercased, in strcmp() order
+    candidates_t *found;    // found[i] holds the alternatives to tokens[i]
+    int count;
+} corrections_t;
+
+
+int compareTokens(const void *a, const void *b){
+    return strcmp(*(char**)a, *(char**)b);
+}
+
+
+// Collect the distinct words of str (lowercased) that the dictionary does not contain, and search the trie for all
+// of their alternatives at once (the limit best of each, or every one at the least distance if limit is 0)
+void findCorrections(dictionary_t *dict, char *str, int limit, corrections_t *fixes){
+    int allocated = 16;
+    fixes->tokens = malloc(sizeof(char*) * allocated);
+    fixes->count = 0;
+
+    // Words are runs of characters between punctuation, as correctSentence() and checkSentence() read them
+    int len = strlen(str);
+    for(int w = 0; w < len; ){
+        if(strchr(PUNCTUATION, str[w]) != NULL){
+            w++;
+            continue;
+        }
+        int t = w;
+        while(t < len && strchr(PUNCTUATION, str[t]) == NULL) t++;
+        char *word = strndup(&str[w], t - w);
+        for(int i = 0; word[i]; i++) word[i] = tolower(word[i]);
+        if(contains(word, dict->table)){
+            free(word);
+        } else {
+            if(fixes->count == allocated){
+                allocated *= 2;
+                fixes->tokens = realloc(fixes->tokens, sizeof(char*) * allocated);
+            }
+            fixes->tokens[fixes->count++] = word;
         }
+        w = t;
+    }
+
+    // Drop repeats
+    qsort(fixes->tokens, fixes->count, sizeof(char*), compareTokens);
+    int distinct = 0;
+    for(int i = 0; i < fixes->count; i++){
+        if(distinct > 0 && strcmp(fixes->tokens[i], fixes->tokens[distinct - 1]) == 0) free(fixes->tokens[i]);
+        else fixes->tokens[distinct++] = fixes->tokens[i];
     }
+    fixes->count = distinct;
+
+    fixes->found = malloc(sizeof(candidates_t) * (distinct > 0 ? distinct : 1));
+    if(distinct > 0) batchEditDistances(fixes->tokens, distinct, &(dict->trie), limit, fixes->found);
+}
+
+
+// The alternatives found for a (lowercased) word, or NULL if it is not misspelled
+candidates_t *lookupCorrection(corrections_t *fixes, char *word){
+    char **token = bsearch(&word, fixes->tokens, fixes->count, sizeof(char*), compareTokens);
+    return (token == NULL) ? NULL : &(fixes->found[token - fixes->tokens]);
 }
 
-// Iterate over the entire hash table, seeking words with minimum edit distances
-// to the indicated string. Forms a built-in linked list over the minima.
-node_t *minimumEditDistances(char *str, node_t **table, int* minDist){
-    // Find minima
-    node_t *minHead = NULL;
-    for(int i = 0; i < HASH_BUCKETS; i++){
-        // Perform recursive tree traversal (high stack space cost, I suppose)
-        minEditDistanceKernel(str, table[i], minDist, &minHead);
+
+void freeCorrections(corrections_t *fixes){
+    for(int i = 0; i < fixes->count; i++){
+        free(fixes->tokens[i]);
+        freeCandidates(&(fixes->found[i]));
     }
-    return minHead;    
-} 
+    free(fixes->tokens);
+    free(fixes->found);
+}
+
+
+// String Correction Mode: writes str to out with every misspelled word replaced by its best-ranked correction
+// (punctuation, and the case of correct words, left as they were)
+void correctSentence(char *str, corrections_t *fixes, FILE *out){
+    int len = strlen(str);
+    // Iterate over the input
+    for(int w = 0; w < len; ){
+        if(strchr(PUNCTUATION, str[w]) != NULL){
+            // Do not modify punctuation
+            fputc(str[w++], out);
+        } else {
+            // Send ahead a tail-reader to read whole words
+            int t = w;
+            while(t < len && strchr(PUNCTUATION, str[t]) == NULL) t++;
+            char* word = strndup(&str[w], t - w);
+
+            // Convert to Lowercase
+            for(int i = 0; word[i]; i++) word[i] = tolower(word[i]);
+
+            candidates_t *found = lookupCorrection(fixes, word);
+            if(found == NULL || found->count == 0){
+                // Append existing word
+                fwrite(&str[w], 1, t - w, out);
+            } else {
+                // Append replacement word (doesn't match case; TODO fix this)
+                fputs(found->words[0].word->word, out);
+            }
+            free(word);
+            w = t;
+        }
+    }
+    fputc('\n', out);
+}
+
+
+// Complete Correction Mode: writes the alternatives found to each misspelled word of str to out
+// (str is tokenized in place)
+void checkSentence(char *str, corrections_t *fixes, FILE *out){
+    // Iterate word-by-word over the input
+    fprintf(out, "Checking string: %s\n", str);
+    // Tokenize string into words
+    char *state;
+    char *word = strtok_r(str, PUNCTUATION, &state);
+    while(word != NULL){
+        // For every word
+
+        // Convert to Lowercase
+        for(int i = 0; word[i]; i++) word[i] = tolower(word[i]);
+        // N.B. the implementation is incomplete for composite number-words like "55th" due to the limitations of the
+        // data-set and the fact that we do not treat words as composites of subwords. A more complete implementation
+        // would address this problem.
+
+        // See if the word was found to be misspelled
+        candidates_t *found = lookupCorrection(fixes, word);
+        if(found != NULL){
+            fprintf(out, "%s is not in the dictionary, did you mean ", word);
+
+            // Print the found minima
+            for(int i = 0; i < found->count; i++){
+                fputs(found->words[i].word->word, out);
+                if (i + 1 < found->count) fputs(" or ", out);
+            }
+
+            fputs("?\n", out);
+        }
+        // Next word
+        word = strtok_r(NULL, PUNCTUATION, &state);
+    }
+}
+
+
+// Corrects str in either mode (with every minimum alternative to each misspelled word listed, or if limit is not 0
+// the limit best), writing what the program prints for it to out
+void correctText(dictionary_t *dict, char *str, bool complete, int limit, FILE *out){
+    corrections_t fixes;
+    findCorrections(dict, str, complete ? limit : 1, &fixes);
+    if(complete) checkSentence(str, &fixes, out);
+    else correctSentence(str, &fixes, out);
+    fputc('\n', out);
+    freeCorrections(&fixes);
+}
+
+
+
+
+// Server mode
+// The dictionary is loaded once and corrections are served over a UNIX domain socket. A request is a 4-byte
+// length (in network byte order) followed by that many bytes: one mode byte, REQUEST_CORRECT or REQUEST_CHECK,
+// and then the text to be corrected. The response is a 4-byte length followed by exactly what the program would
+// print for that text (after loading the dictionary) in that mode. A connection may carry any number of requests;
+// they are answered in order.
+// One thread runs an epoll loop over the connections; parsed requests are handed to a pool of workers, which
+// write their responses to memory and hand them back to the loop to be sent.
+#define REQUEST_CORRECT 's'
+#define REQUEST_CHECK 'c'
+
+// The largest request accepted, in bytes
+#define MAX_REQUEST_LENGTH (1 << 20)
+
+// Events taken from epoll at a time
+#define MAX_EVENTS 64
+
+
+// A client's connection
+typedef struct connection {
+    int fd;
+    char *in;                   // Bytes received and not yet parsed into a request
+    size_t inUsed;
+    size_t inAllocated;
+    bool eof;                   // The client has finished sending
+
+    // The request with the workers (or the response being sent), which the epoll loop leaves alone while busy
+    bool busy;
+    char mode;
+    char *text;
+    char *out;                  // The response, length prefix included
+    size_t outLength;
+    size_t outSent;
+    bool closing;               // The client went away while busy; free this when the workers are done with it
+    struct connection *next;    // Link in the work or done queue
+} connection_t;
+
+
+// State shared by the epoll loop and the workers
+typedef struct server {
+    dictionary_t *dict;
+    int limit;                  // Alternatives listed for each misspelled word (0 for all at the least distance)
+    int epoll;
+    int wake;                   // An eventfd through which the workers tell the loop of finished requests
+    connection_t *workHead;     // Requests waiting for a worker
+    connection_t *workTail;
+    connection_t *done;         // Responses waiting to be sent
+    bool stopping;
+    pthread_mutex_t lock;       // Guards the queues and stopping
+    pthread_cond_t work;        // Signalled when a request is queued, or the server stops
+} server_t;
+
+
+// Set by SIGINT and SIGTERM
+volatile sig_atomic_t stopServer = 0;
+
+void onStopSignal(int signal){
+    (void)signal;
+    stopServer = 1;
+}
+
+
+// A worker: answers requests until the server stops
+void *correctionWorker(void *arg){
+    server_t *server = (server_t*)arg;
+    pthread_mutex_lock(&(server->lock));
+    while(true){
+        while(server->workHead == NULL && !server->stopping) pthread_cond_wait(&(server->work), &(server->lock));
+        if(server->stopping) break;
+        connection_t *conn = server->workHead;
+        server->workHead = conn->next;
+        if(server->workHead == NULL) server->workTail = NULL;
+        pthread_mutex_unlock(&(server->lock));
+
+        // Correct the text into memory, behind room for the length prefix
+        char *response;
+        size_t responseLength;
+        FILE *out = open_memstream(&response, &responseLength);
+        fwrite("\0\0\0\0", 1, 4, out);
+        correctText(server->dict, conn->text, conn->mode == REQUEST_CHECK, server->limit, out);
+        fclose(out);
+        uint32_t length = htonl((uint32_t)(responseLength - 4));
+        memcpy(response, &length, 4);
+        free(conn->text);
+        conn->text = NULL;
+        conn->out = response;
+        conn->outLength = responseLength;
+        conn->outSent = 0;
+
+        pthread_mutex_lock(&(server->lock));
+        conn->next = server->done;
+        server->done = conn;
+        uint64_t one = 1;
+        if(write(server->wake, &one, sizeof(one)) < 0) perror("Couldn't wake the server");
+    }
+    pthread_mutex_unlock(&(server->lock));
+    return NULL;
+}
+
+
+// Stop watching a connection for anything but errors and hangups (while it is busy), or watch it for events
+void watchConnection(server_t *server, connection_t *conn, uint32_t events){
+    struct epoll_event ev;
+    ev.events = events;
+    ev.data.ptr = conn;
+    epoll_ctl(server->epoll, EPOLL_CTL_MOD, conn->fd, &ev);
+}
+
+
+void freeConnection(connection_t *conn){
+    free(conn->in);
+    free(conn->text);
+    free(conn->out);
+    free(conn);
+}
+
+
+// Hang up on a client; a busy connection is freed once its request comes back from the workers
+void closeConnection(server_t *server, connection_t *conn){
+    epoll_ctl(server->epoll, EPOLL_CTL_DEL, conn->fd, NULL);
+    close(conn->fd);
+    conn->fd = -1;
+    if(conn->busy) conn->closing = true;
+    else freeConnection(conn);
+}
+
+
+// Hand the first request buffered on a connection to the workers, if it has arrived in full
+// Returns false if the connection is to be closed: the client sent a malformed request, or has finished
+// sending and has no requests left.
+bool dispatchRequest(server_t *server, connection_t *conn){
+    uint32_t length = 0;
+    if(conn->inUsed >= 4){
+        memcpy(&length, conn->in, 4);
+        length = ntohl(length);
+        if(length < 1 || length > MAX_REQUEST_LENGTH) return false;
+        if(conn->inUsed > 4 && conn->in[4] != REQUEST_CORRECT && conn->in[4] != REQUEST_CHECK) return false;
+    }
+    if(conn->inUsed < 4 || conn->inUsed < 4 + (size_t)length) return !conn->eof;
+
+    conn->mode = conn->in[4];
+    conn->text = strndup(&(conn->in[5]), length - 1);
+    conn->inUsed -= 4 + length;
+    memmove(conn->in, &(conn->in[4 + length]), conn->inUsed);
+    conn->busy = true;
+    watchConnection(server, conn, 0);
+
+    pthread_mutex_lock(&(server->lock));
+    conn->next = NULL;
+    if(server->workTail == NULL) server->workHead = conn;
+    else server->workTail->next = conn;
+    server->workTail = conn;
+    pthread_cond_signal(&(server->work));
+    pthread_mutex_unlock(&(server->lock));
+    return true;
+}
+
+
+// Read whatever a client has sent, and dispatch its request once complete
+// Returns false if the connection is to be closed.
+bool readConnection(server_t *server, connection_t *conn){
+    while(true){
+        if(conn->inAllocated - conn->inUsed < MAX_WORD_LENGTH){
+            if(conn->inAllocated > MAX_REQUEST_LENGTH + 4) return false;
+            conn->inAllocated *= 2;
+            conn->in = realloc(conn->in, conn->inAllocated);
+        }
+        ssize_t got = read(conn->fd, &(conn->in[conn->inUsed]), conn->inAllocated - conn->inUsed);
+        if(got > 0){
+            conn->inUsed += got;
+        } else if(got == 0){
+            conn->eof = true;
+            break;
+        } else if(errno == EAGAIN || errno == EWOULDBLOCK){
+            break;
+        } else if(errno != EINTR){
+            return false;
+        }
+    }
+    return dispatchRequest(server, conn);
+}
+
+
+// Send as much of a connection's response as the socket will take; once all is sent, go on to its next request
+// Returns false if the connection is to be closed.
+bool sendResponse(server_t *server, connection_t *conn){
+    while(conn->outSent < conn->outLength){
+        ssize_t sent = send(conn->fd, &(conn->out[conn->outSent]), conn->outLength - conn->outSent, MSG_NOSIGNAL);
+        if(sent >= 0){
+            conn->outSent += sent;
+        } else if(errno == EAGAIN || errno == EWOULDBLOCK){
+            watchConnection(server, conn, EPOLLOUT);
+            return true;
+        } else if(errno != EINTR){
+            return false;
+        }
+    }
+    free(conn->out);
+    conn->out = NULL;
+    conn->busy = false;
+    watchConnection(server, conn, EPOLLIN);
+    return dispatchRequest(server, conn);
+}
+
+
+// Serve corrections from dict on the socket at path, with the given number of workers and limit on alternatives,
+// until interrupted
+// Returns the status the program should exit with.
+int serve(dictionary_t *dict, const char *path, int threads, int limit){
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if(strlen(path) >= sizeof(address.sun_path)){
+        fprintf(stderr, "Socket path %s is too long\n", path);
+        return 2;
+    }
+    strcpy(address.sun_path, path);
+
+    int listener = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    unlink(path);   // A socket left behind by an earlier server
+    if(listener < 0 || bind(listener, (struct sockaddr*)&address, sizeof(address)) != 0 || listen(listener, SOMAXCONN) != 0){
+        fprintf(stderr, "Couldn't listen on %s: ", path);
+        perror(NULL);
+        return 2;
+    }
+
+    server_t server;
+    memset(&server, 0, sizeof(server));
+    server.dict = dict;
+    server.limit = limit;
+    server.epoll = epoll_create1(EPOLL_CLOEXEC);
+    server.wake = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    pthread_mutex_init(&(server.lock), NULL);
+    pthread_cond_init(&(server.work), NULL);
+
+    // The listener and the eventfd are told apart from connections by their addresses
+    struct epoll_event ev;
+    ev.events = EPOLLIN;
+    ev.data.ptr = &listener;
+    epoll_ctl(server.epoll, EPOLL_CTL_ADD, listener, &ev);
+    ev.data.ptr = &(server.wake);
+    epoll_ctl(server.epoll, EPOLL_CTL_ADD, server.wake, &ev);
+
+    // The stop signals stay blocked (and the workers inherit that) except while this thread is in
+    // epoll_pwait(), which unblocks them atomically; one arriving between the check of stopServer and the
+    // wait is held until the wait begins, and then interrupts it
+    sigset_t stopSignals, waitMask;
+    sigemptyset(&stopSignals);
+    sigaddset(&stopSignals, SIGINT);
+    sigaddset(&stopSignals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &stopSignals, &waitMask);
+    sigdelset(&waitMask, SIGINT);
+    sigdelset(&waitMask, SIGTERM);
+    pthread_t *workers = malloc(sizeof(pthread_t) * threads);
+    for(int i = 0; i < threads; i++) pthread_create(&(workers[i]), NULL, correctionWorker, &server);
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = onStopSignal;
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+
+    printf("Serving corrections on %s with %d workers\n", path, threads);
+    fflush(stdout);
+
+    struct epoll_event events[MAX_EVENTS];
+    while(!stopServer){
+        int n = epoll_pwait(server.epoll, events, MAX_EVENTS, -1, &waitMask);
+        if(n < 0){
+            if(errno == EINTR) continue;
+            perror("epoll_pwait");
+            break;
+        }
+        for(int i = 0; i < n; i++){
+            if(events[i].data.ptr == &listener){
+                // Accept every waiting client
+                int fd;
+                while((fd = accept4(listener, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0){
+                    connection_t *conn = calloc(1, sizeof(connection_t));
+                    conn->fd = fd;
+                    conn->inAllocated = 4096;
+                    conn->in = malloc(conn->inAllocated);
+                    ev.events = EPOLLIN;
+                    ev.data.ptr = conn;
+                    epoll_ctl(server.epoll, EPOLL_CTL_ADD, fd, &ev);
+                }
+            } else if(events[i].data.ptr == &(server.wake)){
+                // Send the responses the workers have finished
+                uint64_t count;
+                if(read(server.wake, &count, sizeof(count)) < 0 && errno != EAGAIN) perror("Couldn't read the eventfd");
+                pthread_mutex_lock(&(server.lock));
+                connection_t *done = server.done;
+                server.done = NULL;
+                pthread_mutex_unlock(&(server.lock));
+                while(done != NULL){
+                    connection_t *conn = done;
+                    done = done->next;
+                    if(conn->closing) freeConnection(conn);
+                    else if(!sendResponse(&server, conn)) closeConnection(&server, conn);
+                }
+            } else {
+                connection_t *conn = (connection_t*)events[i].data.ptr;
+                bool open = true;
+                if(events[i].events & (EPOLLERR | EPOLLHUP) && conn->busy){
+                    open = false;
+                } else if(events[i].events & EPOLLOUT){
+                    open = sendResponse(&server, conn);
+                } else if(events[i].events & (EPOLLIN | EPOLLERR | EPOLLHUP)){
+                    open = readConnection(&server, conn);
+                }
+                if(!open) closeConnection(&server, conn);
+            }
+        }
+    }
+
+    // Stop the workers; any connections still open are left to the OS, like the dictionary
+    pthread_mutex_lock(&(server.lock));
+    server.stopping = true;
+    pthread_cond_broadcast(&(server.work));
+    pthread_mutex_unlock(&(server.lock));
+    for(int i = 0; i < threads; i++) pthread_join(workers[i], NULL);
+    free(workers);
+    close(listener);
+    unlink(path);
+    printf("Server stopped\n");
+    return 0;
+}
+
+
+
+
+// Client mode
+// Write or read exactly length bytes
+bool sendAll(int fd, const char *buffer, size_t length){
+    while(length > 0){
+        ssize_t sent = send(fd, buffer, length, MSG_NOSIGNAL);
+        if(sent < 0 && errno == EINTR) continue;
+        if(sent <= 0) return false;
+        buffer += sent;
+        length -= sent;
+    }
+    return true;
+}
+
+bool receiveAll(int fd, char *buffer, size_t length){
+    while(length > 0){
+        ssize_t got = read(fd, buffer, length);
+        if(got < 0 && errno == EINTR) continue;
+        if(got <= 0) return false;
+        buffer += got;
+        length -= got;
+    }
+    return true;
+}
+
+
+// Read all of stdin, returning it with a terminator and storing its length in *length
+char *readInput(size_t *length){
+    size_t used = 0, allocated = MAX_SENTENCE_LENGTH + 1;
+    char *input = malloc(allocated);
+    ssize_t got;
+    while((got = read(STDIN_FILENO, &input[used], allocated - used - 1)) > 0){
+        used += got;
+        if(used == allocated - 1){
+            allocated *= 2;
+            input = realloc(input, allocated);
+        }
+    }
+    input[used] = '\0';
+    *length = used;
+    return input;
+}
+
+
+// Seconds on the monotonic clock
+double now(void){
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + (t.tv_nsec / 1e9);
+}
+
+
+// Send the text of length bytes to the server on fd in the given mode, and print its response
+// Returns the round trip in seconds, or a negative number (having said why on stderr) if the server did not answer
+double request(int fd, char mode, const char *text, size_t length){
+    double start = now();
+    uint32_t header = htonl((uint32_t)(length + 1));
+    char *message = malloc(length + 5);
+    memcpy(message, &header, 4);
+    message[4] = mode;
+    memcpy(&message[5], text, length);
+    bool sent = sendAll(fd, message, length + 5);
+    free(message);
+
+    uint32_t responseLength;
+    if(!sent || !receiveAll(fd, (char*)&responseLength, 4)){
+        fprintf(stderr, "The server hung up\n");
+        return -1;
+    }
+    responseLength = ntohl(responseLength);
+    char *response = malloc(responseLength);
+    if(!receiveAll(fd, response, responseLength)){
+        fprintf(stderr, "The server hung up\n");
+        free(response);
+        return -1;
+    }
+    double elapsed = now() - start;
+    fwrite(response, 1, responseLength, stdout);
+    fflush(stdout);
+    free(response);
+    return elapsed;
+}
+
+
+// Correct standard input through the server on the socket at path, as one request or (if perLine) one request per
+// line, reporting the latency of each on stderr
+// Returns the status the program should exit with.
+int client(const char *path, bool complete, bool perLine){
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if(strlen(path) >= sizeof(address.sun_path)){
+        fprintf(stderr, "Socket path %s is too long\n", path);
+        return 2;
+    }
+    strcpy(address.sun_path, path);
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if(fd < 0 || connect(fd, (struct sockaddr*)&address, sizeof(address)) != 0){
+        fprintf(stderr, "Couldn't connect to %s: ", path);
+        perror(NULL);
+        return 2;
+    }
+
+    size_t length;
+    char *input = readInput(&length);
+    if(length >= MAX_REQUEST_LENGTH){
+        fprintf(stderr, "Input of %zu bytes is too long for one request\n", length);
+        return 2;
+    }
+
+    char mode = complete ? REQUEST_CHECK : REQUEST_CORRECT;
+    int status = 0;
+    if(!perLine){
+        double elapsed = request(fd, mode, input, length);
+        if(elapsed < 0) status = 2;
+        else fprintf(stderr, "Request answered in %.3f ms\n", elapsed * 1000);
+    } else {
+        int requests = 0;
+        double total = 0, longest = 0;
+        for(size_t start = 0; start < length; ){
+            char *newline = memchr(&input[start], '\n', length - start);
+            size_t end = (newline == NULL) ? length : (size_t)(newline - input) + 1;
+            double elapsed = request(fd, mode, &input[start], end - start);
+            if(elapsed < 0){
+                status = 2;
+                break;
+            }
+            fprintf(stderr, "Request %d answered in %.3f ms\n", ++requests, elapsed * 1000);
+            total += elapsed;
+            if(elapsed > longest) longest = elapsed;
+            start = end;
+        }
+        if(requests > 0) fprintf(stderr, "%d requests: mean %.3f ms, longest %.3f ms\n", requests, total * 1000 / requests, longest * 1000);
+    }
+
+    free(input);
+    close(fd);
+    return status;
+}
 
 
 
@@ -203,124 +1140,83 @@ node_t *minimumEditDistances(char *str, node_t **table, int* minDist){
 // Main function
 // If there are two arguments the program prints the table and Levenshtein distance between the arguments
 // Otherwise it treats stdin as a set of words to be autocorrected
+// Options:
+//   -c prints every minimum alternative to each misspelled word, rather than the corrected sentence
+//   -k lists only the k best alternatives instead, at whatever distance, ranked by distance and then by the frequency
+//      column of the dictionary (if it has one)
+//   -b corrects the whole of stdin as one document, rather than its first MAX_SENTENCE_LENGTH bytes
+//   -S <socket> loads the dictionary once and serves corrections over a UNIX domain socket until interrupted,
+//      on -j worker threads (one per online processor by default), with -k applying to every request
+//   -C <socket> corrects stdin through a server started with -S, reporting the latency on stderr; with -l, each
+//      line of stdin is sent as a request of its own
 int main(int argc, char** argv){
-    if (argc == 3){
+    if (argc == 3 && argv[1][0] != '-'){
         // Two-word compute mode
         printf("Distance between %s and %s: %d\n", argv[1], argv[2], editDistance(argv[1],argv[2], false));
-    } else if (argc == 1 || (argc == 2 && strcmp(argv[1], "-c") == 0)){
-        // Stdin autocorrect mode
-        // Cheap and easy read of stdin for short test sentences (the assignment is not about parsing input after all!)
-        char str[MAX_SENTENCE_LENGTH + 1];
-        str[read(STDIN_FILENO, &str, MAX_SENTENCE_LENGTH)] = '\0';
-
-        // Read in the entire English Dictionary
-        // TODO: turn this into a memory-mapped custom data structure for efficient loading
-
-        // Make Hash Table
-        node_t **table = calloc(HASH_BUCKETS, sizeof(node_t*));
-        
-        printf("Please wait, loading English Dictionary into hash table...\n");
-        // Iterate over Dictionary
-        char buffer[MAX_WORD_LENGTH];
-        FILE *fp = fopen("words.txt", "r");
-        if (fp == NULL) perror("Couldn't get words.txt"); 
-        while (fgets(buffer, MAX_WORD_LENGTH, fp)) {
-            int len = strlen(buffer);
-            if (buffer[len - 1] == '\n') buffer[len - 1] = '\0';    // Trim off trailing newline
-            // Convert to Lowercase
-            for(int i = 0; buffer[i]; i++) buffer[i] = tolower(buffer[i]);
-            // Append the word to the Hash Table
-            addNode(buffer, table);
-        }
-        fclose(fp);
-        printf("English Dictionary Loaded.\n");
-
-        if(argc == 1){
-            // String Correction Mode
-            char output[strlen(str) * EXPANSION_FACTOR];    // Prepare an output buffer
-            int o = 0;                                      // Index into the output
-            output[o] = '\0';
-            
-            // Iterate over the input
-            for(int w = 0; w < strlen(str); ){
-                if(strchr(PUNCTUATION, str[w]) != NULL){
-                    // Do not modify punctuation
-                    output[o++] = str[w++];
-                    output[o] = '\0';
-                } else {
-                    // Send ahead a tail-reader to read whole words
-                    for(int t = w; t < strlen(str); t++){
-                        if(strchr(PUNCTUATION, str[t]) != NULL){
-                            // We've reached the end of a word
-                            char* word = strndup(&str[w], t - w);
-                            
-                            // Convert to Lowercase
-                            for(int i = 0; word[i]; i++) word[i] = tolower(word[i]);
-
-                            if(contains(word, table)){
-                                // Append existing word
-                                strcat(output, &str[w]);
-                                o += t - w; 
-                            } else {
-                                // Append replacement word (doesn't match case; TODO fix this)
-                                int minimumDistance = INT_MAX;
-                                char* replacement = minimumEditDistances(word, table, &minimumDistance)->word;
-                                strcat(output, replacement);
-                                o += strlen(replacement);
-                            }
-
-                            free(word);
-                            w = t;
-                            break;
-                        }
-                    }
-                }
+        return 0;
+    }
+
+    bool complete = false, perLine = false, document = false;
+    char *servePath = NULL, *clientPath = NULL;
+    long threads = sysconf(_SC_NPROCESSORS_ONLN);
+    long limit = 0;
+    int opt;
+    while((opt = getopt(argc, argv, "bcC:j:k:lS:")) != -1){
+        if(opt == 'b'){
+            document = true;
+        } else if(opt == 'c'){
+            complete = true;
+        } else if(opt == 'C'){
+            clientPath = optarg;
+        } else if(opt == 'j'){
+            threads = atol(optarg);
+        } else if(opt == 'k'){
+            limit = atol(optarg);
+            if(limit < 1){
+                fprintf(stderr, "-k must be at least 1\n");
+                return 5;
             }
-            
-            printf("%s\n", output);
+        } else if(opt == 'l'){
+            perLine = true;
+        } else if(opt == 'S'){
+            servePath = optarg;
         } else {
-            // Complete Correction Mode
-            // Iterate word-by-word over the input
-            printf("Checking string: %s\n", str);
-            // Tokenize string into words
-            char *word = strtok(str, PUNCTUATION);
-            while(word != NULL){
-                // For every word
-
-                // Convert to Lowercase
-                for(int i = 0; word[i]; i++) word[i] = tolower(word[i]);
-                // N.B. the implementation is incomplete for composite number-words like "55th" due to the limitations of the
-                // data-set and the fact that we do not treat words as composites of subwords. A more complete implementation
-                // would address this problem.
-
-                // Scan the Hash Table to see if the word exists
-                if(!contains(word, table)){
-                    printf("%s is not in the dictionary, did you mean ", word);
-                    // Find possible alternatives
-                    int minimumDistance = INT_MAX;
-                    node_t* minHead = minimumEditDistances(word, table, &minimumDistance);
-
-                    // Print the found minima
-                    while(minHead != NULL){
-                        printf("%s", minHead->word);
-                        if (minHead->N != NULL) printf(" or ");
-                        minHead = minHead->N;
-                    }
-
-                    printf("?\n");
-                }
-                // Next word
-                word = strtok(NULL, PUNCTUATION);
-            }
+            argc = 0;   // Fall through to the help message
+            break;
         }
+    }
 
-        // Leak the Hash Table's memory; as loading is a onetime operation, we can let the OS clear up our mess
-        printf("\n");
-
-    } else {
+    if (argc - optind != 0 || threads < 1 || (servePath != NULL && (clientPath != NULL || complete || document)) || (document && clientPath != NULL) || (perLine && clientPath == NULL) || (limit > 0 && (clientPath != NULL || (!complete && servePath == NULL)))){
         // Help message
-        fprintf(stderr, "Usage:\n\teditDistance <word1> <word2> for Comparison Mode\n\teditDistance [-c] for String Correction mode.\n\tIn String Correction Mode, pass in the sentence to be corrected to stdin. If -c is specified,\n\tprogram will print all relevant correction alternatives. If not it will print only one corrected sentence.\n");
+        fprintf(stderr, "Usage:\n\teditDistance <word1> <word2> for Comparison Mode\n\teditDistance [-c [-k N]] [-b] for String Correction mode.\n\tIn String Correction Mode, pass in the sentence to be corrected to stdin. If -c is specified,\n\tprogram will print all relevant correction alternatives. If not it will print only one corrected sentence.\n\tWith -b, the whole of stdin is corrected rather than its first %d bytes.\n", MAX_SENTENCE_LENGTH);
+        fprintf(stderr, "\tWith -k N (which needs -c), -c lists the N best alternatives, ranked by distance and then by the dictionary's frequency column.\n");
+        fprintf(stderr, "\teditDistance -S <socket> [-j threads] [-k N] to serve String Correction requests from a resident dictionary.\n\teditDistance [-c] [-l] -C <socket> to correct stdin through that server (per line with -l).\n");
         return 5;
     }
+
+    if (clientPath != NULL) return client(clientPath, complete, perLine);
+
+    // Stdin autocorrect mode
+    // Cheap and easy read of stdin for short test sentences (the assignment is not about parsing input after all!)
+    char str[MAX_SENTENCE_LENGTH + 1];
+    char *text = str;
+    size_t length;
+    if (document){
+        // Batch Correction Mode; every misspelled word of the document is corrected in a single pass over the dictionary
+        text = readInput(&length);
+    } else if (servePath == NULL){
+        ssize_t got = read(STDIN_FILENO, &str, MAX_SENTENCE_LENGTH);
+        str[(got < 0) ? 0 : got] = '\0';
+    }
+
+    dictionary_t dict;
+    printf("Please wait, loading English Dictionary into hash table...\n");
+    if (!loadDictionary("words.txt", &dict)) return 2;
+    printf("English Dictionary Loaded.\n");
+
+    if (servePath != NULL) return serve(&dict, servePath, (int)threads, (int)limit);
+
+    correctText(&dict, text, complete, (int)limit, stdout);
+    // Leak the Hash Table's memory; as loading is a onetime operation, we can let the OS clear up our mess
     return 0;
 }
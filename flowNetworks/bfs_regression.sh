@@ -0,0 +1,28 @@
+#!/bin/bash
+
+# Runs max_flow_generator's Edmonds-Karp engine over a run of seeded random
+# flow networks and totals the augmenting paths and edge scans it reports,
+# so that changes to breadthFirstSearch() can be compared before and after.
+# Usage: bfs_regression.sh [number of networks (default 1000)]
+
+
+count=${1:-1000}
+mkdir -p regression_graphs
+
+paths=0
+scans=0
+seed=1
+while [ $seed -le $count ]
+do
+
+./flow_network_generator regression_$seed regression_graphs/input.dot $seed 2> /dev/null
+report=$(./max_flow_generator -v -a edmonds-karp regression_graphs/input.dot regression_graphs/output.dot 2>&1)
+
+# Pull the counts out of "edmonds-karp: maximum flow F, P augmenting paths, ..., S edge scans"
+paths=$((paths + $(echo "$report" | sed 's/.*, \([0-9]*\) augmenting paths.*/\1/')))
+scans=$((scans + $(echo "$report" | sed 's/.*, \([0-9]*\) edge scans.*/\1/')))
+
+((seed++))
+done
+
+echo "$count networks: $paths augmenting paths, $scans edge scans"
@@ -0,0 +1,37 @@
+#!/bin/bash
+
+# Applies small files of capacity changes (max_flow_generator -d) to a
+# three-vertex network and checks the capacity each leaves on the edge 1 -> 3,
+# which the network does not have until the changes add it. Later lines must
+# find the edge earlier lines added rather than adding it a second time.
+# Usage: changes_regression.sh (exits 1 if any case fails)
+
+
+mkdir -p regression_graphs
+cat > regression_graphs/changes.dot << EOF
+digraph g {
+1 -> 2 [label = " 10 "];
+2 -> 3 [label = " 1 "];
+}
+EOF
+
+failed=0
+check(){
+printf "$1" > regression_graphs/changes.txt
+./max_flow_generator -a dinic -d regression_graphs/changes.txt regression_graphs/changes.dot regression_graphs/output.dot
+capacity=$(sed -n 's/^1 -> 3 \[label = " [0-9]*\/\([0-9]*\) "\];$/\1/p' regression_graphs/output.dot)
+if [ "${capacity:-0}" != "$2" ]
+then
+echo "changes \"$1\" left 1 -> 3 with capacity ${capacity:-0}, not $2"
+failed=1
+fi
+}
+
+check '1 3 7\n1 3 7\n' 7
+check '1 3 7\n1 3 -2\n' 5
+check '1 3 7\n1 3 +4\n' 11
+check '1 3 7\n1 3 -7\n' 0
+check '1 3 7\n1 3 -7\n1 3 +4\n' 4
+check '1 3 +3\n2 3 4\n1 3 +3\n' 6
+
+exit $failed
@@ -0,0 +1,188 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "flow_gen.h"
+#include "flow_io.h"
+
+/* flow_gen.c
+ *
+ * The network topologies of flow_gen.h
+ */
+
+
+const char *familyNames[FAMILY_COUNT] = {"random", "layered", "grid", "bipartite", "adversarial"};
+
+
+
+// Counter-based random numbers: the r'th random number of edge k is a hash of (seed, k, r), so every edge has
+// its own stream and no state is shared between threads. The hash is the SplitMix64 finalizer.
+uint64_t counterRandom(generator_t *g, size_t k, unsigned int r){
+    uint64_t z = g->seed + (((uint64_t)k * 4) + r + 1) * 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// A random number in 0 .. n - 1 (for n < 2^32) from the r'th random number of edge k
+uint32_t randomBelow(generator_t *g, size_t k, unsigned int r, size_t n){
+    return (uint32_t)(((counterRandom(g, k, r) >> 32) * (uint64_t)n) >> 32);
+}
+
+
+// Lays out a generator for the given family, number of vertices (which families round to their shape) and
+// number of edges (which some families take as a guide only, or ignore)
+// Returns false, having reported why on stderr, if no such network can be made.
+bool planNetwork(generator_t *g, size_t vertices, size_t edges){
+    if(vertices < 4){
+        fprintf(stderr, "A generated network needs at least 4 vertices\n");
+        return false;
+    }
+
+    size_t inner = vertices - 2;    // Vertices besides Source and Sink
+    size_t side = 1;
+    while((side + 1) * (side + 1) <= inner) side++;
+
+    if(g->family == FAMILY_RANDOM){
+        // The first |V| - 1 edges lead from each vertex to a random higher one, so the Sink is always reachable
+        g->vertices = vertices;
+        g->edges = (edges < vertices - 1) ? vertices - 1 : edges;
+    } else if(g->family == FAMILY_LAYERED){
+        g->columns = side;
+        g->rows = inner / side;
+        g->vertices = (g->rows * g->columns) + 2;
+        size_t between = (g->rows - 1) * g->columns;
+        g->degree = (between == 0) ? 0 : edges / between;
+        if(g->degree < 1) g->degree = 1;
+        if(g->degree > g->columns) g->degree = g->columns;
+        g->edges = (2 * g->columns) + (between * g->degree);
+    } else if(g->family == FAMILY_GRID){
+        g->rows = side;
+        g->columns = inner / side;
+        g->vertices = (g->rows * g->columns) + 2;
+        g->edges = (2 * g->rows) + (2 * g->rows * (g->columns - 1)) + (2 * (g->rows - 1) * g->columns);
+    } else if(g->family == FAMILY_BIPARTITE){
+        g->rows = inner / 2;
+        g->columns = inner - g->rows;
+        g->vertices = vertices;
+        g->edges = g->rows + g->columns + ((edges < g->rows) ? g->rows : edges);
+    } else {
+        g->vertices = vertices;
+        g->edges = 2 * inner;
+    }
+
+    if(g->vertices > UINT32_MAX || g->edges > ((size_t)1 << 40)){
+        fprintf(stderr, "%zu vertices and %zu edges is too large a network\n", g->vertices, g->edges);
+        return false;
+    }
+    return true;
+}
+
+
+// Computes edge k of the network g describes, with its endpoints numbered from zero
+void generateEdge(generator_t *g, size_t k, uint32_t *from, uint32_t *to, uint32_t *capacity){
+    uint32_t sink = (uint32_t)(g->vertices - 1);
+    *capacity = randomBelow(g, k, 0, g->maxCapacity) + 1;
+
+    if(g->family == FAMILY_RANDOM){
+        if(k < sink){
+            *from = (uint32_t)k;
+            *to = (uint32_t)k + 1 + randomBelow(g, k, 1, sink - k);
+        } else {
+            // Any edge but a self-loop
+            *from = randomBelow(g, k, 1, g->vertices);
+            *to = (*from + 1 + randomBelow(g, k, 2, g->vertices - 1)) % g->vertices;
+        }
+
+    } else if(g->family == FAMILY_LAYERED){
+        // Source to the first layer, the layers in turn, then the last layer to Sink
+        size_t width = g->columns;
+        size_t between = (g->rows - 1) * width * g->degree;
+        if(k < width){
+            *from = 0;
+            *to = (uint32_t)(1 + k);
+        } else if(k < width + between){
+            size_t vertex = (k - width) / g->degree;
+            *from = (uint32_t)(1 + vertex);
+            *to = (uint32_t)(1 + (((vertex / width) + 1) * width) + randomBelow(g, k, 1, width));
+        } else {
+            *from = (uint32_t)(1 + ((g->rows - 1) * width) + (k - width - between));
+            *to = sink;
+        }
+
+    } else if(g->family == FAMILY_GRID){
+        // Source to the left column, the right column to Sink, then edges right and left, then down and up
+        size_t R = g->rows, C = g->columns;
+        size_t across = 2 * R * (C - 1);
+        if(k < R){
+            *from = 0;
+            *to = (uint32_t)(1 + (k * C));
+        } else if(k < 2 * R){
+            *from = (uint32_t)(1 + ((k - R) * C) + (C - 1));
+            *to = sink;
+        } else if(k < (2 * R) + across){
+            size_t i = (k - (2 * R)) / 2;
+            uint32_t cell = (uint32_t)(1 + ((i / (C - 1)) * C) + (i % (C - 1)));
+            bool right = ((k - (2 * R)) % 2) == 0;
+            *from = right ? cell : cell + 1;
+            *to = right ? cell + 1 : cell;
+        } else {
+            size_t i = (k - (2 * R) - across) / 2;
+            uint32_t cell = (uint32_t)(1 + i);
+            bool down = ((k - (2 * R) - across) % 2) == 0;
+            *from = down ? cell : cell + (uint32_t)C;
+            *to = down ? cell + (uint32_t)C : cell;
+        }
+
+    } else if(g->family == FAMILY_BIPARTITE){
+        // Source to every left vertex, every right vertex to Sink, then random left to right edges
+        size_t L = g->rows, R = g->columns;
+        *capacity = 1;
+        if(k < L){
+            *from = 0;
+            *to = (uint32_t)(1 + k);
+        } else if(k < L + R){
+            *from = (uint32_t)(1 + k);
+            *to = sink;
+        } else if(k < 2 * L + R){
+            // Every left vertex has at least one edge
+            *from = (uint32_t)(1 + (k - L - R));
+            *to = (uint32_t)(1 + L + randomBelow(g, k, 1, R));
+        } else {
+            *from = (uint32_t)(1 + randomBelow(g, k, 1, L));
+            *to = (uint32_t)(1 + L + randomBelow(g, k, 2, R));
+        }
+
+    } else {
+        // Source -> 1 -> 2 -> ... -> |V| - 2, every chain vertex with a unit edge to Sink. The chain can carry
+        // all the flow, so a shortest-augmenting-path method finds |V| - 2 paths, each one edge longer than the last.
+        if(k == 0){
+            *from = 0;
+            *to = 1;
+            *capacity = sink;
+        } else if(k < sink - 1){
+            *from = (uint32_t)k;
+            *to = (uint32_t)(k + 1);
+            *capacity = sink;
+        } else {
+            *from = (uint32_t)(k - sink + 2);
+            *to = sink;
+            *capacity = 1;
+        }
+    }
+}
+
+
+void generateEdgelist(generator_t *g, edgelist_t *list){
+    initEdgelist(list);
+    list->allocated = g->edges;
+    list->edges = (edge_t *)malloc(g->edges * sizeof(edge_t));
+    for(size_t k = 0; k < g->edges; k++){
+        uint32_t from, to, capacity;
+        generateEdge(g, k, &from, &to, &capacity);
+        addEdge(list, from, to, capacity);
+    }
+    list->vertices = g->vertices;
+    normalizeEdges(list);
+}
@@ -0,0 +1,58 @@
+#ifndef FLOW_GEN_H
+#define FLOW_GEN_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "max_flow.h"
+
+/* flow_gen.h
+ *
+ * Generating flow networks of any size from a handful of topologies, for
+ * flow_network_generator and max_flow_benchmark.
+ * Source is vertex zero and Sink is vertex |V| - 1, as in max_flow.h.
+ */
+
+
+// The topologies the scalable generator can produce, selected with -f
+typedef enum family {
+
+    FAMILY_RANDOM,          // Uniformly random edges over a path of rising vertex numbers from Source to Sink
+    FAMILY_LAYERED,         // Layers of equal width, each vertex with edges to random vertices of the next layer
+    FAMILY_GRID,            // A rectangular grid with edges both ways between neighbours, fed along its left column
+    FAMILY_BIPARTITE,       // A unit-capacity bipartite matching problem
+    FAMILY_ADVERSARIAL      // A chain draining to the Sink at every vertex; one augmenting path per vertex
+
+} family_t;
+
+// Command-line names of the above, in the same order
+#define FAMILY_COUNT 5
+extern const char *familyNames[FAMILY_COUNT];
+
+
+// The shape of a network to generate. Edges are numbered, and each is a pure function of the seed and its
+// number, so that any range of them can be generated independently of the rest.
+typedef struct generator {
+
+    family_t family;
+    uint64_t seed;
+    unsigned int maxCapacity;   // Capacities are drawn from 1 .. maxCapacity
+    size_t vertices;            // The number of vertices; Source is vertex 0 and Sink vertex |V| - 1
+    size_t edges;               // The number of edges
+    size_t rows, columns;       // Layered: layers and their width; Grid: its dimensions; Bipartite: left and right sides
+    size_t degree;              // Layered: edges from each vertex to the next layer
+
+} generator_t;
+
+
+// Lays out a network of the family set in g; see flow_gen.c
+bool planNetwork(generator_t *g, size_t vertices, size_t edges);
+
+// Computes edge k (0 <= k < g->edges) of the network g describes
+void generateEdge(generator_t *g, size_t k, uint32_t *from, uint32_t *to, uint32_t *capacity);
+
+// Generates the whole network g describes into list (which need not be initialized), merging any parallel edges
+void generateEdgelist(generator_t *g, edgelist_t *list);
+
+#endif
@@ -0,0 +1,747 @@
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "flow_io.h"
+
+/* flow_io.c
+ *
+ * Single-pass readers for the flow network file formats described in flow_io.h.
+ * Files are memory-mapped and scanned once; edges are collected into a growable
+ * Edge List, from which a graph representation is built once they are all known.
+ * Networks and flows are written through a buffered writer that formats numbers itself.
+ */
+
+
+// Edges an Edge List has room for when first grown
+#define EDGELIST_INITIAL_SIZE 64
+
+// The longest line we would expect in a file of capacity changes
+#define CHANGE_LINE_BUFFER_LENGTH 128
+
+// The size of a writer's buffer
+#define WRITER_BUFFER_SIZE 65536
+
+
+
+// Edge List helpers
+void initEdgelist(edgelist_t *list){
+    list->vertices = 0;
+    list->count = 0;
+    list->allocated = 0;
+    list->edges = NULL;
+}
+
+
+// Appends the edge from->to (numbered from zero), doubling the list's space as needed
+void addEdge(edgelist_t *list, unsigned int from, unsigned int to, unsigned int capacity){
+    if(list->count == list->allocated){
+        list->allocated = (list->allocated == 0) ? EDGELIST_INITIAL_SIZE : 2 * list->allocated;
+        list->edges = (edge_t *)realloc(list->edges, list->allocated * sizeof(edge_t));
+    }
+    edge_t *e = &(list->edges[list->count++]);
+    e->from = from;
+    e->to = to;
+    e->capacity = capacity;
+
+    unsigned int highest = (from > to) ? from : to;
+    if(highest + 1 > list->vertices) list->vertices = highest + 1;
+}
+
+
+// Sorts the list by tail and then head vertex, merging parallel edges (by summing their capacities)
+// and dropping self-loops and edges of zero capacity, none of which can carry flow of their own.
+// Two stable counting-sort passes; O(|V| + |E|) operation
+void normalizeEdges(edgelist_t *list){
+    size_t V = list->vertices;
+    size_t *offset = (size_t *)malloc((V + 1) * sizeof(size_t));
+    edge_t *sorted = (edge_t *)malloc(list->count * sizeof(edge_t));
+
+    for(int pass = 0; pass < 2; pass++){
+        // First pass keys on the head vertex, the second on the tail
+        memset(offset, 0, (V + 1) * sizeof(size_t));
+        for(size_t i = 0; i < list->count; i++){
+            offset[((pass == 0) ? list->edges[i].to : list->edges[i].from) + 1]++;
+        }
+        for(size_t v = 0; v < V; v++) offset[v + 1] += offset[v];
+        for(size_t i = 0; i < list->count; i++){
+            sorted[offset[(pass == 0) ? list->edges[i].to : list->edges[i].from]++] = list->edges[i];
+        }
+        edge_t *temp = list->edges;
+        list->edges = sorted;
+        sorted = temp;
+    }
+
+    // Merge runs of parallel edges in place
+    size_t kept = 0;
+    for(size_t i = 0; i < list->count; i++){
+        edge_t e = list->edges[i];
+        if(e.from == e.to || e.capacity == 0) continue;
+        if(kept > 0 && list->edges[kept - 1].from == e.from && list->edges[kept - 1].to == e.to){
+            list->edges[kept - 1].capacity += e.capacity;
+        } else {
+            list->edges[kept++] = e;
+        }
+    }
+    list->count = kept;
+
+    free(offset);
+    free(sorted);
+}
+
+
+void freeEdgelist(edgelist_t *list){
+    free(list->edges);
+    initEdgelist(list);
+}
+
+
+
+
+
+// A cursor over a mapped file, with enough context to report errors
+typedef struct scanner {
+
+    const char *p;              // The next unread byte
+    const char *end;            // One past the last byte
+    size_t line;                // The line p is on, counting from 1
+    const char *path;
+    bool flows;                 // Whether edge labels are to be read as flows rather than capacities
+
+} scanner_t;
+
+
+// Reports a parse error at the scanner's current line; always returns false
+bool parseError(scanner_t *s, const char *message){
+    fprintf(stderr, "%s:%zu: %s\n", s->path, s->line, message);
+    return false;
+}
+
+
+// Skips spaces, tabs and carriage returns; newlines too if crossLines is set
+void skipSpace(scanner_t *s, bool crossLines){
+    while(s->p < s->end){
+        char c = *(s->p);
+        if(c == '\n'){
+            if(!crossLines) return;
+            s->line++;
+        } else if(c != ' ' && c != '\t' && c != '\r'){
+            return;
+        }
+        s->p++;
+    }
+}
+
+
+// Skips to the start of the next line
+void skipLine(scanner_t *s){
+    while(s->p < s->end && *(s->p) != '\n') s->p++;
+    if(s->p < s->end){
+        s->p++;
+        s->line++;
+    }
+}
+
+
+// Reads an unsigned decimal number; returns false if there is none or it overflows 32 bits
+bool scanUnsigned(scanner_t *s, unsigned int *value){
+    if(s->p == s->end || *(s->p) < '0' || *(s->p) > '9') return false;
+    uint64_t v = 0;
+    while(s->p < s->end && *(s->p) >= '0' && *(s->p) <= '9'){
+        v = (v * 10) + (unsigned int)(*(s->p) - '0');
+        if(v > UINT32_MAX) return false;
+        s->p++;
+    }
+    *value = (unsigned int)v;
+    return true;
+}
+
+
+// Reads a vertex number, checking that it is numbered from 1 as in all the file formats
+bool scanEdgeEnd(scanner_t *s, unsigned int *vertex){
+    if(!scanUnsigned(s, vertex)) return parseError(s, "expected a vertex number");
+    if(*vertex == 0) return parseError(s, "vertices are numbered from 1");
+    return true;
+}
+
+
+
+
+
+// Reads a DOT identifier, number or quoted string into [*start, *start + *length), leaving quotes and escapes in place
+// Returns false at the end of the input or on something that is none of these.
+bool scanDotToken(scanner_t *s, const char **start, size_t *length){
+    skipSpace(s, true);
+    if(s->p == s->end) return false;
+    *start = s->p;
+    if(*(s->p) == '"'){
+        s->p++;
+        while(s->p < s->end && *(s->p) != '"'){
+            if(*(s->p) == '\\' && s->p + 1 < s->end) s->p++;
+            if(*(s->p) == '\n') s->line++;
+            s->p++;
+        }
+        if(s->p == s->end) return parseError(s, "unterminated string");
+        s->p++;
+    } else {
+        while(s->p < s->end && (*(s->p) == '_' || *(s->p) == '.' || *(s->p) == '/' ||
+              (*(s->p) >= '0' && *(s->p) <= '9') || (*(s->p) >= 'a' && *(s->p) <= 'z') || (*(s->p) >= 'A' && *(s->p) <= 'Z'))){
+            s->p++;
+        }
+        if(s->p == *start) return false;
+    }
+    *length = s->p - *start;
+    return true;
+}
+
+
+bool tokenIs(const char *start, size_t length, const char *word){
+    return strlen(word) == length && strncmp(start, word, length) == 0;
+}
+
+
+// Reads the value out of an edge label: " 7 " for a network, or " 3/7 " for a flow (whose capacity is 7).
+// If the scanner is reading flows the label must be of the second kind, and its flow (3) is read instead.
+bool dotLabelValue(scanner_t *s, const char *start, size_t length, unsigned int *value){
+    scanner_t label = {start, start + length, s->line, s->path, s->flows};
+    if(label.p < label.end && *(label.p) == '"'){
+        label.p++;
+        label.end--;
+    }
+    skipSpace(&label, false);
+    if(!scanUnsigned(&label, value)) return parseError(s, "edge label is not a capacity");
+    skipSpace(&label, false);
+    if(label.p < label.end && *(label.p) == '/'){
+        unsigned int capacity;
+        label.p++;
+        skipSpace(&label, false);
+        if(!scanUnsigned(&label, &capacity)) return parseError(s, "edge label is not a flow/capacity pair");
+        if(!s->flows) *value = capacity;
+    } else if(s->flows){
+        return parseError(s, "edge label is not a flow/capacity pair");
+    }
+    return true;
+}
+
+
+// Reads an edge's attribute list, [label = " 7 "], into its capacity (or flow); other attributes are ignored
+bool scanDotAttributes(scanner_t *s, unsigned int *capacity, bool *labelled){
+    const char *key, *value;
+    size_t keyLength, valueLength;
+    s->p++;     // The opening bracket
+    while(true){
+        skipSpace(s, true);
+        if(s->p < s->end && (*(s->p) == ',' || *(s->p) == ';')){
+            s->p++;
+            continue;
+        }
+        if(s->p < s->end && *(s->p) == ']'){
+            s->p++;
+            return true;
+        }
+        if(!scanDotToken(s, &key, &keyLength)) return parseError(s, "malformed attribute list");
+        skipSpace(s, true);
+        if(s->p == s->end || *(s->p) != '=') return parseError(s, "expected '=' in attribute list");
+        s->p++;
+        if(!scanDotToken(s, &value, &valueLength)) return parseError(s, "expected an attribute value");
+        if(tokenIs(key, keyLength, "label")){
+            if(!dotLabelValue(s, value, valueLength, capacity)) return false;
+            *labelled = true;
+        }
+    }
+}
+
+
+// Reads the subset of DOT written by this project: a digraph of numbered vertices whose edges are labelled
+// with their capacities, and a graph label naming it. Node statements and other attributes are skipped.
+bool readDot(scanner_t *s, edgelist_t *list, char **name){
+    const char *token;
+    size_t length;
+
+    // digraph [id] {
+    if(!scanDotToken(s, &token, &length) || !tokenIs(token, length, "digraph")) return parseError(s, "expected digraph");
+    skipSpace(s, true);
+    if(s->p < s->end && *(s->p) != '{') scanDotToken(s, &token, &length);
+    skipSpace(s, true);
+    if(s->p == s->end || *(s->p) != '{') return parseError(s, "expected '{'");
+    s->p++;
+
+    while(true){
+        skipSpace(s, true);
+        if(s->p == s->end) return parseError(s, "unexpected end of file; expected '}'");
+        char c = *(s->p);
+        if(c == '}') return true;
+        if(c == ';' || c == ','){
+            s->p++;
+            continue;
+        }
+
+        if(c >= '0' && c <= '9'){
+            // An edge, u -> v [attributes], or a node statement
+            unsigned int from, to, capacity = 0;
+            bool labelled = false;
+            if(!scanEdgeEnd(s, &from)) return false;
+            skipSpace(s, true);
+            if(s->end - s->p < 2 || s->p[0] != '-' || s->p[1] != '>'){
+                // Node statement; skip its attributes
+                if(s->p < s->end && *(s->p) == '['){
+                    if(!scanDotAttributes(s, &capacity, &labelled)) return false;
+                }
+                continue;
+            }
+            s->p += 2;
+            skipSpace(s, true);
+            if(!scanEdgeEnd(s, &to)) return false;
+            skipSpace(s, true);
+            if(s->p < s->end && *(s->p) == '['){
+                if(!scanDotAttributes(s, &capacity, &labelled)) return false;
+            }
+            if(!labelled) return parseError(s, "edge has no capacity label");
+            addEdge(list, from - 1, to - 1, capacity);
+            continue;
+        }
+
+        // An assignment (key = value) or an attribute statement (graph/node/edge [attributes])
+        const char *value;
+        size_t valueLength;
+        if(!scanDotToken(s, &token, &length)) return parseError(s, "unexpected character");
+        skipSpace(s, true);
+        if(s->p < s->end && *(s->p) == '['){
+            unsigned int ignored;
+            bool labelled;
+            if(!scanDotAttributes(s, &ignored, &labelled)) return false;
+            continue;
+        }
+        if(s->p == s->end || *(s->p) != '=') return parseError(s, "expected an edge or an assignment");
+        s->p++;
+        if(!scanDotToken(s, &value, &valueLength)) return parseError(s, "expected a value");
+        if(tokenIs(token, length, "label")){
+            // Keep the graph's name, unquoted
+            if(*value == '"'){
+                value++;
+                valueLength -= 2;
+            }
+            free(*name);
+            *name = strndup(value, valueLength);
+        }
+    }
+}
+
+
+// Reads a text edge list: one "tail head capacity" triple per line, with # starting a comment
+bool readTextEdges(scanner_t *s, edgelist_t *list){
+    while(true){
+        skipSpace(s, false);
+        if(s->p == s->end) return true;
+        if(*(s->p) == '\n' || *(s->p) == '#'){
+            skipLine(s);
+            continue;
+        }
+        unsigned int from, to, capacity;
+        if(!scanEdgeEnd(s, &from)) return false;
+        skipSpace(s, false);
+        if(!scanEdgeEnd(s, &to)) return false;
+        skipSpace(s, false);
+        if(!scanUnsigned(s, &capacity)) return parseError(s, "expected a capacity");
+        skipSpace(s, false);
+        if(s->p < s->end && *(s->p) != '\n' && *(s->p) != '#') return parseError(s, "trailing characters after edge");
+        addEdge(list, from - 1, to - 1, capacity);
+    }
+}
+
+
+// Reads a binary edge list
+bool readBinaryEdges(scanner_t *s, edgelist_t *list){
+    edgefileheader_t header;
+    if((size_t)(s->end - s->p) < sizeof(header)) return parseError(s, "truncated binary edge list header");
+    memcpy(&header, s->p, sizeof(header));
+    s->p += sizeof(header);
+
+    if((uint64_t)(s->end - s->p) / (3 * sizeof(uint32_t)) < header.edges) return parseError(s, "truncated binary edge list");
+    list->allocated = header.edges;
+    list->edges = (edge_t *)malloc(header.edges * sizeof(edge_t));
+    for(uint64_t i = 0; i < header.edges; i++){
+        uint32_t record[3];
+        memcpy(record, s->p, sizeof(record));
+        s->p += sizeof(record);
+        if(record[0] == 0 || record[1] == 0) return parseError(s, "vertices are numbered from 1");
+        addEdge(list, record[0] - 1, record[1] - 1, record[2]);
+    }
+    if(header.vertices > list->vertices) list->vertices = header.vertices;
+    return true;
+}
+
+
+
+
+
+// Reads a binary flow (see flowfileheader_t) into list, each edge's capacity field holding its flow
+bool readBinaryFlows(scanner_t *s, edgelist_t *list){
+    flowfileheader_t header;
+    if((size_t)(s->end - s->p) < sizeof(header)) return parseError(s, "truncated binary flow header");
+    memcpy(&header, s->p, sizeof(header));
+    s->p += sizeof(header);
+
+    if((uint64_t)(s->end - s->p) / (4 * sizeof(uint32_t)) < header.edges) return parseError(s, "truncated binary flow");
+    list->allocated = header.edges;
+    list->edges = (edge_t *)malloc(header.edges * sizeof(edge_t));
+    for(uint64_t i = 0; i < header.edges; i++){
+        uint32_t record[4];
+        memcpy(record, s->p, sizeof(record));
+        s->p += sizeof(record);
+        if(record[0] == 0 || record[1] == 0) return parseError(s, "vertices are numbered from 1");
+        addEdge(list, record[0] - 1, record[1] - 1, record[2]);
+    }
+    if(header.vertices > list->vertices) list->vertices = header.vertices;
+    return true;
+}
+
+
+
+// Reads the network (or flow) at path, in whichever format it turns out to be
+bool readEdgesFile(const char *path, edgelist_t *list, char **name, bool flows){
+    initEdgelist(list);
+    *name = NULL;
+
+    // Map the file into memory
+    int fd = open(path, O_RDONLY);
+    if(fd == -1){
+        fprintf(stderr, "Couldn't open %s for reading\n", path);
+        return false;
+    }
+    struct stat fileStats;
+    fstat(fd, &fileStats);
+    if(fileStats.st_size == 0){
+        fprintf(stderr, "%s is empty\n", path);
+        close(fd);
+        return false;
+    }
+    char *text = mmap(NULL, fileStats.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(text == MAP_FAILED){
+        fprintf(stderr, "Couldn't map %s\n", path);
+        return false;
+    }
+    madvise(text, fileStats.st_size, MADV_SEQUENTIAL);
+
+    // Tell the formats apart
+    scanner_t s = {text, text + fileStats.st_size, 1, path, flows};
+    bool ok;
+    if((size_t)fileStats.st_size >= strlen(EDGE_FILE_MAGIC) && memcmp(text, EDGE_FILE_MAGIC, strlen(EDGE_FILE_MAGIC)) == 0){
+        ok = readBinaryEdges(&s, list);
+    } else if((size_t)fileStats.st_size >= strlen(FLOW_FILE_MAGIC) && memcmp(text, FLOW_FILE_MAGIC, strlen(FLOW_FILE_MAGIC)) == 0){
+        ok = flows ? readBinaryFlows(&s, list) : parseError(&s, "this is a flow, not a network");
+    } else {
+        skipSpace(&s, true);
+        if(s.p < s.end && *(s.p) >= '0' && *(s.p) <= '9'){
+            ok = readTextEdges(&s, list);
+        } else if(s.p < s.end && *(s.p) == '#'){
+            ok = readTextEdges(&s, list);
+        } else {
+            ok = readDot(&s, list, name);
+        }
+    }
+    munmap(text, fileStats.st_size);
+
+    if(ok){
+        normalizeEdges(list);
+        if(!flows && (list->count == 0 || list->vertices < 2)){
+            fprintf(stderr, "%s has no edges\n", path);
+            ok = false;
+        }
+    }
+    if(!ok){
+        freeEdgelist(list);
+        free(*name);
+        *name = NULL;
+        return false;
+    }
+
+    // Unnamed networks take the name of their file
+    if(*name == NULL){
+        const char *base = strrchr(path, '/');
+        *name = strdup((base == NULL) ? path : base + 1);
+    }
+    return true;
+}
+
+
+bool readNetwork(const char *path, edgelist_t *list, char **name){
+    return readEdgesFile(path, list, name, false);
+}
+
+
+bool readFlows(const char *path, edgelist_t *flows){
+    char *name;
+    if(!readEdgesFile(path, flows, &name, true)) return false;
+    free(name);
+    return true;
+}
+
+
+
+// Finds edge from->to in a normalized list by binary search; returns NULL if there is none
+edge_t *findEdge(edgelist_t *list, unsigned int from, unsigned int to){
+    size_t low = 0, high = list->count;
+    while(low < high){
+        size_t mid = low + (high - low) / 2;
+        edge_t *e = &(list->edges[mid]);
+        if(e->from < from || (e->from == from && e->to < to)){
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    if(low < list->count && list->edges[low].from == from && list->edges[low].to == to) return &(list->edges[low]);
+    return NULL;
+}
+
+
+// Applies a file of capacity changes to a normalized list, one "u v change" line per edge. A change of +n or -n
+// adjusts the edge's capacity (never below zero); an unsigned n replaces it. Changes to edges the network does not
+// have add them, and edges whose capacity falls to zero are removed.
+bool applyCapacityChanges(const char *path, edgelist_t *list){
+    FILE *fp = fopen(path, "r");
+    if(fp == NULL){
+        fprintf(stderr, "Couldn't open %s for reading\n", path);
+        return false;
+    }
+
+    // The list as it was and the edges the changes add are each kept sorted, so a change finds its edge by
+    // binary search in either, even one added earlier in the file; a final normalization merges the two
+    size_t originalCount = list->count;
+    char buffer[CHANGE_LINE_BUFFER_LENGTH];
+    scanner_t s = {NULL, NULL, 0, path, false};
+    while(fgets(buffer, CHANGE_LINE_BUFFER_LENGTH, fp)){
+        s.p = buffer;
+        s.end = buffer + strlen(buffer);
+        s.line++;
+
+        skipSpace(&s, true);
+        if(s.p == s.end || *(s.p) == '#') continue;
+        unsigned int from, to, amount;
+        if(!scanEdgeEnd(&s, &from)) break;
+        skipSpace(&s, false);
+        if(!scanEdgeEnd(&s, &to)) break;
+        skipSpace(&s, false);
+        char sign = (s.p < s.end && (*(s.p) == '+' || *(s.p) == '-')) ? *(s.p++) : '=';
+        if(!scanUnsigned(&s, &amount)){
+            parseError(&s, "expected a capacity or change in capacity");
+            break;
+        }
+        if(from > list->vertices || to > list->vertices){
+            parseError(&s, "no such vertex in the network");
+            break;
+        }
+        from--;
+        to--;
+
+        edgelist_t original = {list->vertices, originalCount, originalCount, list->edges};
+        edgelist_t added = {list->vertices, list->count - originalCount, list->count - originalCount,
+                            list->edges + originalCount};
+        edge_t *e = findEdge(&original, from, to);
+        if(e == NULL) e = findEdge(&added, from, to);
+
+        long long capacity = (e == NULL) ? 0 : e->capacity;
+        if(sign == '+') capacity += amount;
+        else if(sign == '-') capacity -= amount;
+        else capacity = amount;
+        if(capacity < 0) capacity = 0;
+        if(capacity > UINT32_MAX) capacity = UINT32_MAX;
+
+        if(e != NULL){
+            e->capacity = (unsigned int)capacity;
+        } else if(capacity > 0){
+            // Insert the new edge in order among those already added
+            size_t position = list->count;
+            while(position > originalCount && (list->edges[position - 1].from > from ||
+                  (list->edges[position - 1].from == from && list->edges[position - 1].to > to))) position--;
+            addEdge(list, from, to, (unsigned int)capacity);
+            edge_t inserted = list->edges[list->count - 1];
+            memmove(&(list->edges[position + 1]), &(list->edges[position]),
+                    (list->count - 1 - position) * sizeof(edge_t));
+            list->edges[position] = inserted;
+        }
+    }
+    bool ok = feof(fp);
+    fclose(fp);
+
+    normalizeEdges(list);
+    return ok;
+}
+
+
+
+
+
+// Writer helpers
+void initWriter(flowwriter_t *w, FILE *fp){
+    w->fp = fp;
+    w->buffer = (char *)malloc(WRITER_BUFFER_SIZE);
+    w->used = 0;
+    w->failed = false;
+}
+
+
+void writeBytes(flowwriter_t *w, const void *bytes, size_t length){
+    if(w->used + length > WRITER_BUFFER_SIZE){
+        if(fwrite(w->buffer, 1, w->used, w->fp) != w->used) w->failed = true;
+        w->used = 0;
+        if(length > WRITER_BUFFER_SIZE){
+            if(fwrite(bytes, 1, length, w->fp) != length) w->failed = true;
+            return;
+        }
+    }
+    memcpy(w->buffer + w->used, bytes, length);
+    w->used += length;
+}
+
+
+void writeText(flowwriter_t *w, const char *text){
+    writeBytes(w, text, strlen(text));
+}
+
+
+// Formats value in decimal at out (which must have room for 10 characters), two digits at a time
+// Returns the number of characters written; there is no terminator.
+size_t formatUnsigned(char *out, unsigned int value){
+    static const char pairs[201] =
+        "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+        "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+        "8081828384858687888990919293949596979899";
+
+    size_t length = 1;
+    for(unsigned int rest = value; rest >= 10; rest /= 10) length++;
+
+    char *p = out + length;
+    while(value >= 100){
+        unsigned int pair = (value % 100) * 2;
+        value /= 100;
+        *--p = pairs[pair + 1];
+        *--p = pairs[pair];
+    }
+    if(value >= 10){
+        *--p = pairs[(value * 2) + 1];
+        *--p = pairs[value * 2];
+    } else {
+        *--p = (char)('0' + value);
+    }
+    return length;
+}
+
+
+void writeUnsigned(flowwriter_t *w, unsigned int value){
+    if(w->used + 10 > WRITER_BUFFER_SIZE){
+        if(fwrite(w->buffer, 1, w->used, w->fp) != w->used) w->failed = true;
+        w->used = 0;
+    }
+    w->used += formatUnsigned(w->buffer + w->used, value);
+}
+
+
+// Writes out whatever is buffered and releases the buffer (but does not close the file)
+// Returns false if anything written through w failed to reach the file.
+bool finishWriter(flowwriter_t *w){
+    if(w->used != 0 && fwrite(w->buffer, 1, w->used, w->fp) != w->used) w->failed = true;
+    free(w->buffer);
+    w->buffer = NULL;
+    w->used = 0;
+    return !w->failed && fflush(w->fp) == 0;
+}
+
+
+
+// Writes the flow along each edge of edges (edgeFlow[i] being that along edges->edges[i]) to path, as DOT or
+// in binary; only edges carrying flow are written
+// Returns false, having reported why on stderr, if the file cannot be written.
+bool writeFlow(const char *path, edgelist_t *edges, unsigned int *edgeFlow, const char *name, unsigned int maxFlow, bool binary){
+    FILE *fp = fopen(path, "w");
+    if (fp == NULL) {
+        fprintf(stderr, "Couldn't open %s for writing\n", path);
+        return false;
+    }
+    flowwriter_t w;
+    initWriter(&w, fp);
+
+    if(binary){
+        flowfileheader_t header;
+        memcpy(header.magic, FLOW_FILE_MAGIC, sizeof(header.magic));
+        header.vertices = (uint32_t)edges->vertices;
+        header.maxFlow = maxFlow;
+        header.edges = 0;
+        for(size_t i = 0; i < edges->count; i++) header.edges += (edgeFlow[i] != 0);
+        writeBytes(&w, &header, sizeof(header));
+        for(size_t i = 0; i < edges->count; i++){
+            if(edgeFlow[i] != 0){
+                uint32_t record[4] = {edges->edges[i].from + 1, edges->edges[i].to + 1, edgeFlow[i], edges->edges[i].capacity};
+                writeBytes(&w, record, sizeof(record));
+            }
+        }
+    } else {
+        // .dot skeleton fleshed with the edges carrying flow, and the total flow size appended to the label
+        writeText(&w, "digraph g{\n\nrankdir = LR\n\n");
+        for(size_t i = 0; i < edges->count; i++){
+            if(edgeFlow[i] != 0){
+                writeUnsigned(&w, edges->edges[i].from + 1);
+                writeText(&w, " -> ");
+                writeUnsigned(&w, edges->edges[i].to + 1);
+                writeText(&w, " [label = \" ");
+                writeUnsigned(&w, edgeFlow[i]);
+                writeText(&w, "/");
+                writeUnsigned(&w, edges->edges[i].capacity);
+                writeText(&w, " \"];\n");
+            }
+        }
+        writeText(&w, "\nlabel = \"");
+        writeText(&w, name);
+        writeText(&w, ": maximum flow = ");
+        writeUnsigned(&w, maxFlow);
+        writeText(&w, " \"\n}\n");
+    }
+
+    bool written = finishWriter(&w);
+    if(fclose(fp) != 0 || !written){
+        fprintf(stderr, "Couldn't write %s\n", path);
+        return false;
+    }
+    return true;
+}
+
+
+// Writes a Gomory-Hu tree as an undirected DOT graph, each vertex joined to its parent by an edge labelled with
+// the minimum cut between them
+bool writeCuttree(const char *path, cuttree_t *tree, const char *name){
+    FILE *fp = fopen(path, "w");
+    if (fp == NULL) {
+        fprintf(stderr, "Couldn't open %s for writing\n", path);
+        return false;
+    }
+    flowwriter_t w;
+    initWriter(&w, fp);
+
+    writeText(&w, "graph g{\n\nrankdir = LR\n\n");
+    for(size_t v = 1; v < tree->vertices; v++){
+        writeUnsigned(&w, (unsigned int)v + 1);
+        writeText(&w, " -- ");
+        writeUnsigned(&w, tree->parent[v] + 1);
+        writeText(&w, " [label = \" ");
+        writeUnsigned(&w, tree->weight[v]);
+        writeText(&w, " \"];\n");
+    }
+    writeText(&w, "\nlabel = \"");
+    writeText(&w, name);
+    writeText(&w, ": Gomory-Hu tree \"\n}\n");
+
+    bool written = finishWriter(&w);
+    if(fclose(fp) != 0 || !written){
+        fprintf(stderr, "Couldn't write %s\n", path);
+        return false;
+    }
+    return true;
+}
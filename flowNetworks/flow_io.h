@@ -0,0 +1,91 @@
+#ifndef FLOW_IO_H
+#define FLOW_IO_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "max_flow.h"
+
+/* flow_io.h
+ *
+ * Reading flow networks from files, and writing them and their flows.
+ * Three formats are understood, and told apart by their first bytes:
+ *   DOT, as written by flow_network_generator:      1 -> 2 [label = " 7 "];
+ *   Text edge lists, one edge per line:             1 2 7
+ *   Binary edge lists, a header and then edges:     see edgefileheader_t
+ * Flows are written as DOT, as max_flow_generator always has, or in binary (see flowfileheader_t).
+ * Vertices are numbered from 1 in every format; Source is the lowest and Sink the highest.
+ */
+
+
+// Marks the start of a binary edge list
+#define EDGE_FILE_MAGIC "FLOWEDGE"
+
+// Binary edge list header, in native byte order. It is followed by `edges` records of three
+// uint32_t each (tail vertex, head vertex, capacity).
+typedef struct edgefileheader {
+
+    char magic[8];              // EDGE_FILE_MAGIC, without its terminator
+    uint32_t vertices;          // The number of vertices in the network
+    uint32_t reserved;          // Zero
+    uint64_t edges;             // The number of edge records that follow
+
+} edgefileheader_t;
+
+
+// Marks the start of a binary flow
+#define FLOW_FILE_MAGIC "FLOWSOLN"
+
+// Binary flow header, in native byte order. It is followed by `edges` records of four uint32_t each
+// (tail vertex, head vertex, flow, capacity), one for each edge carrying flow.
+typedef struct flowfileheader {
+
+    char magic[8];              // FLOW_FILE_MAGIC, without its terminator
+    uint32_t vertices;          // The number of vertices in the network
+    uint32_t maxFlow;           // The value of the flow
+    uint64_t edges;             // The number of edge records that follow
+
+} flowfileheader_t;
+
+
+// A buffered writer, through which networks and flows are streamed to a file a piece at a time
+typedef struct flowwriter {
+
+    FILE *fp;
+    char *buffer;
+    size_t used;                // Bytes waiting in the buffer
+    bool failed;                // Whether a write to fp has failed
+
+} flowwriter_t;
+
+
+// Edge list helpers
+void initEdgelist(edgelist_t *list);
+void addEdge(edgelist_t *list, unsigned int from, unsigned int to, unsigned int capacity);
+void normalizeEdges(edgelist_t *list);
+void freeEdgelist(edgelist_t *list);
+
+// Reads the network at path into list, and its DOT label (or else the file's name) into *name.
+// Returns false, having reported why on stderr, if the file cannot be read or is malformed.
+bool readNetwork(const char *path, edgelist_t *list, char **name);
+
+// Reads a flow, as written by max_flow_generator (as DOT or in binary), into flows; each edge's capacity field holds its flow.
+// Edge list files are read as for readNetwork(), with the third number of each edge taken as its flow.
+bool readFlows(const char *path, edgelist_t *flows);
+
+// Capacity changes, for warm-starting from a previous flow
+edge_t *findEdge(edgelist_t *list, unsigned int from, unsigned int to);
+bool applyCapacityChanges(const char *path, edgelist_t *list);
+
+// Writing
+void initWriter(flowwriter_t *w, FILE *fp);
+void writeBytes(flowwriter_t *w, const void *bytes, size_t length);
+void writeText(flowwriter_t *w, const char *text);
+void writeUnsigned(flowwriter_t *w, unsigned int value);
+size_t formatUnsigned(char *out, unsigned int value);
+bool finishWriter(flowwriter_t *w);
+bool writeFlow(const char *path, edgelist_t *edges, unsigned int *edgeFlow, const char *name, unsigned int maxFlow, bool binary);
+bool writeCuttree(const char *path, cuttree_t *tree, const char *name);
+
+#endif
@@ -1,8 +1,14 @@
+#include <pthread.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
+#include <unistd.h>
+
+#include "flow_gen.h"
+#include "flow_io.h"
 
 /* flow_network_generator.c
  *
@@ -26,21 +32,22 @@
 #define COP_OUT_LIMIT 5
 
 
-// The longest .dot description we would expect to see for any given edge of the network
-// derived from our precondition that 5 <= |V| <= 15 and assumption that |E| <= |V|^2
-// and the MAX_EDGE_CAPACITY (though doing so at compile-time would mean involving logarithms, 
-// which would be annoying). Also includes space for null-termination.
-#define MAX_EDGE_STRING_LENGTH 29
-
-
 
-// An Adjacency Matrix
-typedef struct adjmatrix {
+// Scalable generation (any option given)
+// Default number of vertices, and of edges per vertex where neither -m nor -d is given
+#define DEFAULT_VERTICES 1000
+#define DEFAULT_EDGES_PER_VERTEX 8
 
-    size_t vertices;            // The number of vertices in the graph
-    unsigned int *matrix;       // matrix[(u * vertices) + v] is the capacity of edge u->v (0 == no edge)
+// Edges generated (and written) as one unit of work by a generating thread
+#define CHUNK_EDGES 65536
 
-} adjmatrix_t;
+// The DOT description of an edge is its 32-bit vertex numbers and capacity (up to 10 digits each), with these
+// between and after them; the longest is 51 characters
+#define MAX_UNSIGNED_DIGITS 10
+#define DOT_EDGE_ARROW " -> "
+#define DOT_EDGE_LABEL " [label = \" "
+#define DOT_EDGE_END " \"];\n"
+#define MAX_DOT_EDGE_LENGTH ((3 * MAX_UNSIGNED_DIGITS) + (sizeof(DOT_EDGE_ARROW) - 1) + (sizeof(DOT_EDGE_LABEL) - 1) + (sizeof(DOT_EDGE_END) - 1))
 
 
 
@@ -130,21 +137,216 @@ void generate_flow(adjmatrix_t *flownet){
 
 
 
+// Shared state of the threads generating a network: each claims the next chunk of edges, renders it into
+// its own buffer, and then waits for the chunks before it to be written before writing its own, so that
+// the output is the same whatever the number of threads
+typedef struct genwriter {
+
+    generator_t *gen;
+    FILE *fp;
+    bool binary;                // Write a binary edge list (see flow_io.h) rather than DOT
+    size_t chunks;              // The number of chunks of edges
+    size_t nextChunk;           // The next chunk to be claimed
+    size_t nextWrite;           // The next chunk to be written
+    bool failed;                // Whether a write has failed
+    pthread_mutex_t lock;
+    pthread_cond_t turn;        // Signalled whenever a chunk has been written
+
+} genwriter_t;
+
+
+void *generateChunks(void *arg){
+    genwriter_t *w = (genwriter_t *)arg;
+    generator_t *g = w->gen;
+    size_t recordLength = w->binary ? 3 * sizeof(uint32_t) : MAX_DOT_EDGE_LENGTH;
+    char *buffer = (char *)malloc(CHUNK_EDGES * recordLength);
+
+    while(true){
+        pthread_mutex_lock(&(w->lock));
+        size_t chunk = w->nextChunk++;
+        pthread_mutex_unlock(&(w->lock));
+        if(chunk >= w->chunks) break;
+
+        // Render the chunk; edges are numbered from 1 in files
+        size_t first = chunk * CHUNK_EDGES;
+        size_t last = (first + CHUNK_EDGES < g->edges) ? first + CHUNK_EDGES : g->edges;
+        char *bufHead = buffer;
+        for(size_t k = first; k < last; k++){
+            uint32_t record[3];
+            generateEdge(g, k, &(record[0]), &(record[1]), &(record[2]));
+            record[0]++;
+            record[1]++;
+            if(w->binary){
+                memcpy(bufHead, record, sizeof(record));
+                bufHead += sizeof(record);
+            } else {
+                bufHead += formatUnsigned(bufHead, record[0]);
+                memcpy(bufHead, DOT_EDGE_ARROW, sizeof(DOT_EDGE_ARROW) - 1);
+                bufHead += sizeof(DOT_EDGE_ARROW) - 1;
+                bufHead += formatUnsigned(bufHead, record[1]);
+                memcpy(bufHead, DOT_EDGE_LABEL, sizeof(DOT_EDGE_LABEL) - 1);
+                bufHead += sizeof(DOT_EDGE_LABEL) - 1;
+                bufHead += formatUnsigned(bufHead, record[2]);
+                memcpy(bufHead, DOT_EDGE_END, sizeof(DOT_EDGE_END) - 1);
+                bufHead += sizeof(DOT_EDGE_END) - 1;
+            }
+        }
+
+        // Write it in turn
+        pthread_mutex_lock(&(w->lock));
+        while(w->nextWrite != chunk) pthread_cond_wait(&(w->turn), &(w->lock));
+        if(fwrite(buffer, 1, bufHead - buffer, w->fp) != (size_t)(bufHead - buffer)) w->failed = true;
+        w->nextWrite++;
+        pthread_cond_broadcast(&(w->turn));
+        pthread_mutex_unlock(&(w->lock));
+    }
+
+    free(buffer);
+    return NULL;
+}
+
+
+// Generates the network g describes into fp on the given number of threads, as DOT (labelled with name) or
+// as a binary edge list
+// Returns false if the output could not be written.
+bool writeNetwork(generator_t *g, FILE *fp, const char *name, bool binary, unsigned int threads){
+    if(binary){
+        edgefileheader_t header;
+        memcpy(header.magic, EDGE_FILE_MAGIC, sizeof(header.magic));
+        header.vertices = (uint32_t)g->vertices;
+        header.reserved = 0;
+        header.edges = g->edges;
+        fwrite(&header, sizeof(header), 1, fp);
+    } else {
+        fprintf(fp, "digraph g{\n\nrankdir = LR\n\n");
+    }
+
+    genwriter_t w;
+    w.gen = g;
+    w.fp = fp;
+    w.binary = binary;
+    w.chunks = (g->edges + CHUNK_EDGES - 1) / CHUNK_EDGES;
+    w.nextChunk = 0;
+    w.nextWrite = 0;
+    w.failed = false;
+    pthread_mutex_init(&(w.lock), NULL);
+    pthread_cond_init(&(w.turn), NULL);
+
+    if(threads > w.chunks) threads = (w.chunks == 0) ? 1 : (unsigned int)w.chunks;
+    pthread_t *workers = (pthread_t *)malloc(threads * sizeof(pthread_t));
+    for(unsigned int i = 1; i < threads; i++) pthread_create(&(workers[i]), NULL, generateChunks, &w);
+    generateChunks(&w);
+    for(unsigned int i = 1; i < threads; i++) pthread_join(workers[i], NULL);
+    free(workers);
+    pthread_mutex_destroy(&(w.lock));
+    pthread_cond_destroy(&(w.turn));
+
+    if(!binary) fprintf(fp, "\nlabel = \"%s\"\n}\n", name);
+    return !w.failed && !ferror(fp);
+}
+
+
+
+
+
 // Main Function
 // Program takes three arguments (the file path to and name of the output and a seed) and produces 
 // a randomly generated flow network as a simple DOT file at the indicated path
 // (as specified in the assignment description)
+// Given any option, it instead generates a network of the chosen size and topology, on several threads,
+// streaming it to the file as it goes. The network depends only on the options and the seed.
+// Options:
+//   -f selects the topology: random (the default), layered, grid, bipartite or adversarial
+//   -n sets the number of vertices (which layered and grid networks round down to fit their shape)
+//   -m sets the number of edges, or -d their density as a percentage of |V|(|V| - 1); layered and bipartite
+//      networks take this as a guide, and grid and adversarial networks ignore it
+//   -c sets the largest capacity (capacities are drawn from 1 .. c)
+//   -j sets the number of generating threads (one per online processor by default)
+//   -b writes a binary edge list (see flow_io.h) rather than DOT
 int main(int argc, char **argv){
 
+    // Parse options
+    generator_t gen;
+    gen.family = FAMILY_RANDOM;
+    gen.maxCapacity = MAX_EDGE_CAPACITY;
+    size_t vertices = DEFAULT_VERTICES;
+    size_t edges = 0;
+    double density = -1;
+    bool binary = false;
+    long threads = sysconf(_SC_NPROCESSORS_ONLN);
+    bool scalable = false;
+    int opt;
+    while((opt = getopt(argc, argv, "bc:d:f:j:m:n:")) != -1){
+        scalable = true;
+        if(opt == 'f'){
+            size_t f = 0;
+            while(f < FAMILY_COUNT && strcmp(optarg, familyNames[f]) != 0) f++;
+            if(f == FAMILY_COUNT){
+                fprintf(stderr, "Unknown topology %s (expected random, layered, grid, bipartite or adversarial)\n", optarg);
+                exit(1);
+            }
+            gen.family = (family_t)f;
+        } else if(opt == 'n'){
+            vertices = strtoull(optarg, NULL, 10);
+        } else if(opt == 'm'){
+            edges = strtoull(optarg, NULL, 10);
+        } else if(opt == 'd'){
+            density = atof(optarg);
+        } else if(opt == 'c'){
+            gen.maxCapacity = (unsigned int)strtoul(optarg, NULL, 10);
+            if(gen.maxCapacity < 1){
+                fprintf(stderr, "The largest capacity must be at least 1\n");
+                exit(1);
+            }
+        } else if(opt == 'j'){
+            threads = atol(optarg);
+            if(threads < 1){
+                fprintf(stderr, "Thread count must be at least 1\n");
+                exit(1);
+            }
+        } else if(opt == 'b'){
+            binary = true;
+        } else {
+            argc = 0;   // Fall through to the usage message
+            break;
+        }
+    }
+
     // Verify argument
-    if (argc != 4){
-        fprintf(stderr, "Usage: flow_network_generator <graph name> <path> <seed>\n");
+    if (argc - optind != 3){
+        fprintf(stderr, "Usage: flow_network_generator [-f random|layered|grid|bipartite|adversarial] [-n vertices] [-m edges | -d density] [-c capacity] [-j threads] [-b] <graph name> <path> <seed>\n");
         exit(1);
     }
+    char *graphName = argv[optind];
+    char *outputPath = argv[optind + 1];
+    char *seed = argv[optind + 2];
+
+
+    if(scalable){
+        // Lay out the network
+        gen.seed = strtoull(seed, NULL, 10);
+        if(density >= 0) edges = (size_t)((density / 100.0) * (double)vertices * (double)(vertices - 1));
+        else if(edges == 0) edges = DEFAULT_EDGES_PER_VERTEX * vertices;
+        if(!planNetwork(&gen, vertices, edges)) exit(1);
+        fprintf(stderr, "Generating a flow network (%s) with %zu vertices and %zu edges\n", familyNames[gen.family], gen.vertices, gen.edges);
+
+        // Stream it out
+        FILE *fp = fopen(outputPath, "w");
+        if (fp == NULL) {
+            fprintf(stderr, "Couldn't open %s for writing\n", outputPath);
+            exit(2);
+        }
+        bool written = writeNetwork(&gen, fp, graphName, binary, (unsigned int)threads);
+        if(fclose(fp) != 0 || !written){
+            fprintf(stderr, "Couldn't write %s\n", outputPath);
+            exit(2);
+        }
+        return 0;
+    }
 
 
     // Seed RNG with input parameter (timing is to close to use time seed)
-    srand(atoi(argv[3]));
+    srand(atoi(seed));
     
 
     // Allocate new adjacency matrix describing our Flow Network
@@ -158,38 +360,44 @@ int main(int argc, char **argv){
     generate_flow(&flownet);
 
 
-    // Convert Flow Network edges to .dot list format string
-    // As per our spec, 5 <= |V| <= 15, so we have a manageable
-    // upper boundary on the buffer
+    FILE *fp = fopen(outputPath, "w");
+    if (fp == NULL) {
+        fprintf(stderr, "Couldn't open %s for writing\n", outputPath); 
+        exit(2);
+    }
+
+
+    // Stream .dot skeleton fleshed with our graph to the file
     // Increment counters so that we have 1-base indexed vertices
-    char buffer[flownet.vertices * flownet.vertices * MAX_EDGE_STRING_LENGTH];
-    char *bufHead = buffer;
+    flowwriter_t w;
+    initWriter(&w, fp);
+    writeText(&w, "digraph g{\n\nrankdir = LR\n\n");
     for(int i = 0; i < flownet.vertices; i++){
         for(int j = 0; j < flownet.vertices; j++){
             // For every edge (i, j)
             unsigned int edgeCapacity = flownet.matrix[(i * flownet.vertices) + j];
             if (edgeCapacity != 0){
-                // An edge exists; append it to our output string
-                bufHead += snprintf(bufHead, MAX_EDGE_STRING_LENGTH, "%d -> %d [label = \" %d \"];\n", i+1, j+1, edgeCapacity);
+                // An edge exists; write it out
+                writeUnsigned(&w, i + 1);
+                writeText(&w, " -> ");
+                writeUnsigned(&w, j + 1);
+                writeText(&w, " [label = \" ");
+                writeUnsigned(&w, edgeCapacity);
+                writeText(&w, " \"];\n");
             }
         }
     }
-    
-    
-
-    FILE *fp = fopen(argv[2], "w");
-    if (fp == NULL) {
-        fprintf(stderr, "Couldn't open %s for writing\n", argv[2]); 
-        exit(2);
-    }
-
-
-    // Write .dot skeleton fleshed with our graph to the file
-    fprintf(fp, "digraph g{\n\nrankdir = LR\n\n%s\nlabel = \"%s\"\n}\n", buffer, argv[1]);
+    writeText(&w, "\nlabel = \"");
+    writeText(&w, graphName);
+    writeText(&w, "\"\n}\n");
 
 
     // Close the file
-    fclose(fp);
+    bool written = finishWriter(&w);
+    if(fclose(fp) != 0 || !written){
+        fprintf(stderr, "Couldn't write %s\n", outputPath);
+        exit(2);
+    }
 
     
     // Clean up
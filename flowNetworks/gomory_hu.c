@@ -0,0 +1,236 @@
+#include <limits.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "flow_io.h"
+#include "max_flow.h"
+
+/* gomory_hu.c
+ *
+ * Gomory-Hu trees by Gusfield's algorithm, for minimum cut queries between any
+ * pair of vertices of a network (taken as undirected, with the capacities of
+ * u->v and v->u summed).
+ *
+ * Gusfield's algorithm makes |V| - 1 maximum flow computations, vertex s against
+ * its current tree parent p[s] for s = 1 .. |V| - 1, and after each hangs the later
+ * vertices on the source side of the cut, that shared p[s]'s parent, onto s. Each
+ * computation depends on the parents left by those before it, so the threads here
+ * run them speculatively: each takes the next vertex and computes its cut against
+ * the parent it has at that moment, and the results are committed strictly in
+ * order of s. A result whose vertex has since been given a different parent is
+ * recomputed by the committing thread before it is committed, so the tree is the
+ * one the sequential algorithm builds.
+ */
+
+
+// Speculative results held at once, per thread
+#define GOMORY_HU_WINDOW_PER_THREAD 2
+
+
+// Shared state of the threads building a tree
+typedef struct ghstate {
+
+    edgelist_t *network;        // The symmetrized network
+    cuttree_t *tree;            // The tree, parent[] holding the parents committed so far
+    flowengine_t engine;
+    size_t window;              // Results held at once
+    unsigned int *against;      // against[slot] is the parent the slot's result was computed against
+    unsigned int *value;        // value[slot] is the result's minimum cut
+    bool *ready;                // Whether a slot's result is waiting to be committed
+    bool *sides;                // sides[(slot * |V|) + v] is whether v is on the source side of the slot's cut
+
+    size_t nextVertex;          // The next vertex to be claimed
+    size_t nextCommit;          // The next vertex to be committed
+    bool committing;            // Whether a thread is committing results (which it may leave the lock to recompute)
+    pthread_mutex_t lock;       // Guards all of the above and tree->parent
+    pthread_cond_t changed;     // Signalled whenever a result is committed
+
+} ghstate_t;
+
+
+// Computes the minimum cut between source and sink of the network, marking the vertices on source's side of it
+// in side[], working in the given scratch space and edge buffer (of the network's size)
+// Returns the value of the cut.
+unsigned int minimumCutBetween(ghstate_t *g, unsigned int source, unsigned int sink, bool *side, edge_t *buffer, flowscratch_t *scratch){
+    edgelist_t *network = g->network;
+    size_t V = network->vertices;
+
+    edgelist_t relabelled = *network;
+    relabelled.edges = buffer;
+    memcpy(buffer, network->edges, network->count * sizeof(edge_t));
+    relabelTerminals(&relabelled, source, sink, false);
+
+    flownet_t net;
+    buildFlownet(&relabelled, &net, scratch);
+    unsigned int cut = g->engine(&net, NULL);
+
+    // The source side is everything still reachable from the source in the residual network
+    bool *reached = (bool *)scratchCalloc(scratch, V, sizeof(bool));
+    unsigned int *queue = (unsigned int *)scratchAlloc(scratch, V * sizeof(unsigned int));
+    size_t qHead = 0, qTail = 0;
+    queue[qTail++] = 0;
+    reached[0] = true;
+    while(qHead < qTail){
+        unsigned int u = queue[qHead++];
+        for(unsigned int a = net.first[u]; a < net.first[u + 1]; a++){
+            if(net.residual[a] != 0 && !reached[net.head[a]]){
+                reached[net.head[a]] = true;
+                queue[qTail++] = net.head[a];
+            }
+        }
+    }
+    for(unsigned int v = 0; v < V; v++) side[v] = reached[terminalRelabel(v, source, sink, V, false)];
+
+    freeFlownet(&net);
+    resetScratch(scratch);
+    return cut;
+}
+
+
+void *gomoryHuWorker(void *arg){
+    ghstate_t *g = (ghstate_t *)arg;
+    cuttree_t *tree = g->tree;
+    size_t V = tree->vertices;
+    edge_t *buffer = (edge_t *)malloc(g->network->count * sizeof(edge_t));
+    flowscratch_t scratch;
+    initScratch(&scratch);
+
+    pthread_mutex_lock(&(g->lock));
+    while(true){
+        // Claim the next vertex, once there is a free slot for its result
+        while(g->nextVertex < V && g->nextVertex >= g->nextCommit + g->window) pthread_cond_wait(&(g->changed), &(g->lock));
+        if(g->nextVertex >= V) break;
+        size_t s = g->nextVertex++;
+        size_t slot = s % g->window;
+        unsigned int t = tree->parent[s];
+        pthread_mutex_unlock(&(g->lock));
+
+        unsigned int cut = minimumCutBetween(g, (unsigned int)s, t, &(g->sides[slot * V]), buffer, &scratch);
+
+        pthread_mutex_lock(&(g->lock));
+        g->against[slot] = t;
+        g->value[slot] = cut;
+        g->ready[slot] = true;
+
+        // Commit every result that is ready, in order, recomputing any whose vertex has since changed parent;
+        // a result finished while another thread is committing is left for that thread
+        if(g->committing) continue;
+        g->committing = true;
+        while(g->nextCommit < V && g->ready[g->nextCommit % g->window]){
+            size_t c = g->nextCommit;
+            size_t cslot = c % g->window;
+            bool *side = &(g->sides[cslot * V]);
+            if(g->against[cslot] != tree->parent[c]){
+                unsigned int parent = tree->parent[c];
+                pthread_mutex_unlock(&(g->lock));
+                g->value[cslot] = minimumCutBetween(g, (unsigned int)c, parent, side, buffer, &scratch);
+                pthread_mutex_lock(&(g->lock));
+                g->against[cslot] = parent;
+            }
+
+            tree->weight[c] = g->value[cslot];
+            for(size_t i = c + 1; i < V; i++){
+                if(side[i] && tree->parent[i] == tree->parent[c]) tree->parent[i] = (unsigned int)c;
+            }
+            g->ready[cslot] = false;
+            g->nextCommit++;
+            pthread_cond_broadcast(&(g->changed));
+        }
+        g->committing = false;
+    }
+    pthread_mutex_unlock(&(g->lock));
+
+    free(buffer);
+    freeScratch(&scratch);
+    return NULL;
+}
+
+
+
+// Gomory-Hu Tree construction (Gusfield's algorithm)
+// Parameters: list, a network, whose edges are taken as undirected
+//             tree, to be filled with its Gomory-Hu tree (free it with freeCuttree())
+//             engine, the maximum flow engine used for each cut (dinic or either push-relabel engine)
+//             threads, the number of threads to run on
+// Makes |V| - 1 maximum flow computations, plus any speculative ones that must be redone.
+void gomoryHuTree(edgelist_t *list, cuttree_t *tree, flowengine_t engine, unsigned int threads){
+    size_t V = list->vertices;
+    if(threads < 1) threads = 1;
+
+    // Symmetrize: u->v and v->u both carry the sum of their capacities
+    edgelist_t network;
+    initEdgelist(&network);
+    for(size_t i = 0; i < list->count; i++){
+        edge_t *e = &(list->edges[i]);
+        addEdge(&network, e->from, e->to, e->capacity);
+        addEdge(&network, e->to, e->from, e->capacity);
+    }
+    network.vertices = V;
+    normalizeEdges(&network);
+
+    tree->vertices = V;
+    tree->parent = (unsigned int *)calloc(V, sizeof(unsigned int));
+    tree->weight = (unsigned int *)calloc(V, sizeof(unsigned int));
+    tree->depth = (unsigned int *)calloc(V, sizeof(unsigned int));
+
+    ghstate_t g;
+    g.network = &network;
+    g.tree = tree;
+    g.engine = engine;
+    g.window = GOMORY_HU_WINDOW_PER_THREAD * threads;
+    g.against = (unsigned int *)calloc(g.window, sizeof(unsigned int));
+    g.value = (unsigned int *)calloc(g.window, sizeof(unsigned int));
+    g.ready = (bool *)calloc(g.window, sizeof(bool));
+    g.sides = (bool *)calloc(g.window * V, sizeof(bool));
+    g.nextVertex = 1;
+    g.nextCommit = 1;
+    g.committing = false;
+    pthread_mutex_init(&(g.lock), NULL);
+    pthread_cond_init(&(g.changed), NULL);
+
+    pthread_t *workers = (pthread_t *)malloc(threads * sizeof(pthread_t));
+    for(unsigned int i = 1; i < threads; i++) pthread_create(&(workers[i]), NULL, gomoryHuWorker, &g);
+    gomoryHuWorker(&g);
+    for(unsigned int i = 1; i < threads; i++) pthread_join(workers[i], NULL);
+    free(workers);
+
+    // Every parent precedes its children, so depths follow in one pass
+    for(size_t v = 1; v < V; v++) tree->depth[v] = tree->depth[tree->parent[v]] + 1;
+
+    pthread_mutex_destroy(&(g.lock));
+    pthread_cond_destroy(&(g.changed));
+    free(g.against);
+    free(g.value);
+    free(g.ready);
+    free(g.sides);
+    freeEdgelist(&network);
+}
+
+
+// Minimum cut query: the least weight on the tree path between u and v, found by walking the deeper of the two
+// up until they meet
+// Returns UINT_MAX if u == v (no cut separates a vertex from itself).
+// O(|V|) operation
+unsigned int minimumCut(cuttree_t *tree, unsigned int u, unsigned int v){
+    unsigned int cut = UINT_MAX;
+    while(u != v){
+        if(tree->depth[u] < tree->depth[v]){
+            unsigned int swap = u;
+            u = v;
+            v = swap;
+        }
+        if(tree->weight[u] < cut) cut = tree->weight[u];
+        u = tree->parent[u];
+    }
+    return cut;
+}
+
+
+void freeCuttree(cuttree_t *tree){
+    free(tree->parent);
+    free(tree->weight);
+    free(tree->depth);
+}
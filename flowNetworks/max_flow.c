@@ -0,0 +1,967 @@
+#include <limits.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "max_flow.h"
+
+
+// Scratch space is handed out in multiples of this many bytes, keeping every array suitably aligned
+#define SCRATCH_ALIGNMENT 16
+
+// The initial space for a scratch space's record of heap allocations
+#define SCRATCH_INITIAL_SPILLS 16
+
+/* max_flow.c
+ *
+ * Written November 30 2019 by Thomas Pinkava for CSC 301
+ * An exercise in the Edmonds-Karp Algorithm, since joined by Dinic's
+ * Algorithm and the Push-Relabel family
+ */
+
+
+// Edmonds-Karp keeps, beside the matrix, a bitset of its nonzero cells: bit v of row u is set iff
+// g->matrix[(u * V) + v] != 0. Rows are padded to whole words, so the bits past |V| are always clear.
+#define BITSET_WORD_BITS 64
+
+// The number of words in a bitset row of a graph with |V| vertices
+size_t bitsetWords(size_t V){
+    return (V + BITSET_WORD_BITS - 1) / BITSET_WORD_BITS;
+}
+
+// The index of the lowest set bit of a nonzero word
+unsigned int lowestBit(uint64_t word){
+#if defined(__GNUC__)
+    return (unsigned int)__builtin_ctzll(word);
+#else
+    unsigned int i = 0;
+    while(!(word & 1)){
+        word >>= 1;
+        i++;
+    }
+    return i;
+#endif
+}
+
+// Sets or clears the bit for cell (u, v) to match the matrix, after the cell has changed
+void syncBit(adjmatrix_t *g, uint64_t *bits, unsigned int u, unsigned int v){
+    uint64_t *word = &(bits[(u * bitsetWords(g->vertices)) + (v / BITSET_WORD_BITS)]);
+    uint64_t mask = (uint64_t)1 << (v % BITSET_WORD_BITS);
+    if(g->matrix[(u * g->vertices) + v] != 0) *word |= mask;
+    else *word &= ~mask;
+}
+
+
+// Breadth-First Search
+// Parameters: g, a graph to search for paths. We assume that vertex 0 is the source and vertex |V| - 1 is the sink (for simplicity)
+//             bits, the bitset of g's nonzero cells (see above)
+//             p, a "parent list"; an array of size |V| such that p[j] == i <==> (i, j) is and edge in the path
+//             queue, an array of size |V|, and visited, fresh, bitset rows; scratch space allocated once by the caller and
+//             reused between searches
+//             stats, which has its edge scan count increased by the cells inspected
+// Returns true iff a path exists from source to sink.
+// Modifies p to reflect the path.
+// Every vertex is enqueued at most once, so the queue is a plain array read from the front and written at the back;
+// vertices leave in the order they were found, so the path found is a shortest one.
+// A vertex's unvisited neighbours are found a word at a time, as its bitset row AND NOT the visited set; the loop
+// doing so is simple enough for the compiler to vectorize, and only the words it leaves nonzero are walked bit by bit.
+// O(|V|^2 / 64) operation on the adjacency matrix
+bool breadthFirstSearch(adjmatrix_t *g, uint64_t *bits, unsigned int* p, unsigned int *queue, uint64_t *visited, uint64_t *fresh, flowstats_t *stats){
+    size_t V = g->vertices;
+    size_t W = bitsetWords(V);
+    uint64_t sinkMask = (uint64_t)1 << ((V - 1) % BITSET_WORD_BITS);
+    uint64_t *sinkWord = &(visited[(V - 1) / BITSET_WORD_BITS]);
+
+    // Clear the "visited" set and parenthood list
+    memset(visited, 0, W * sizeof(uint64_t));
+    memset(p, 0, V * sizeof(unsigned int));
+
+    // Visit and enqueue source node
+    size_t qHead = 0, qTail = 0;
+    queue[qTail++] = 0;
+    visited[0] = 1;
+
+    // Run BFS traversal, stopping as soon as the sink is found
+    while(qHead < qTail && !(*sinkWord & sinkMask)){
+        unsigned int vertex = queue[qHead++];
+        uint64_t *row = &(bits[vertex * W]);
+
+        // Mark as visited all unvisited adjacent vertices to "vertex"
+        for(size_t w = 0; w < W; w++){
+            fresh[w] = row[w] & ~visited[w];
+            visited[w] |= row[w];
+        }
+
+        // Enqueue and reparent them to "vertex"
+        for(size_t w = 0; w < W; w++){
+            uint64_t word = fresh[w];
+            while(word != 0){
+                unsigned int i = (unsigned int)(w * BITSET_WORD_BITS) + lowestBit(word);
+                word &= word - 1;
+                queue[qTail++] = i;
+                p[i] = vertex;
+            }
+        }
+        stats->edgeScans += V;
+    }
+
+    // Return whether we touched the sink
+    return (*sinkWord & sinkMask) != 0;
+}
+
+
+
+// Edmonds-Karp helper function: finds cf(p), the maximum flow through a path (i.e. the capacity of its weakest edge)
+// Parameters: g, p; these are identical to the parameters for BFS above and p should have been produced by an invocation of BFS.
+// O(|p|) operation
+unsigned int pathCapacity(adjmatrix_t *g, unsigned int* p){
+    unsigned int pathCap;
+    memset(&pathCap, 0xFF, sizeof(unsigned int));    // A cheap and perhaps incorrect approximation of infinite capacity
+
+    unsigned int vertex = g->vertices - 1;  // Start at the sink
+    while(vertex != 0){     // Repeat until we hit the source
+        unsigned int edgeCost = g->matrix[(p[vertex] * g->vertices) + vertex];
+        pathCap = (edgeCost < pathCap) ? edgeCost : pathCap;                    // Store the minimum capacity along the path
+        vertex = p[vertex];
+    }
+    return pathCap;
+}
+
+
+
+// Edmonds-Karp Algorithm
+// Parameters: g, the flow network to be operated upon; this will be overwritten with the residual graph.
+//             f, a space to store the resultant flow graph
+//             stats, to be filled with operation counts (may be NULL)
+// Returns the maximal flow capacity.
+// O(|V||E|^2) algorithm
+unsigned int edmondsKarp(adjmatrix_t *g, adjmatrix_t *f, flowstats_t *stats){
+    // Initialize various things
+    unsigned int maxFlow = 0;
+    flowstats_t counts = {0};
+    unsigned int *p = (unsigned int *)scratchAlloc(g->scratch, g->vertices * sizeof(unsigned int));
+    unsigned int *queue = (unsigned int *)scratchAlloc(g->scratch, g->vertices * sizeof(unsigned int));
+    size_t W = bitsetWords(g->vertices);
+    uint64_t *visited = (uint64_t *)scratchAlloc(g->scratch, W * sizeof(uint64_t));
+    uint64_t *fresh = (uint64_t *)scratchAlloc(g->scratch, W * sizeof(uint64_t));
+
+    // Build the bitset of nonzero cells, which is kept in step with the matrix below
+    uint64_t *bits = (uint64_t *)scratchCalloc(g->scratch, g->vertices * W, sizeof(uint64_t));
+    for(unsigned int u = 0; u < g->vertices; u++){
+        for(unsigned int v = 0; v < g->vertices; v++){
+            if(g->matrix[(u * g->vertices) + v] != 0) bits[(u * W) + (v / BITSET_WORD_BITS)] |= (uint64_t)1 << (v % BITSET_WORD_BITS);
+        }
+    }
+
+    while(breadthFirstSearch(g, bits, p, queue, visited, fresh, &counts)){
+        // While we can find an augmenting path
+        counts.augmentingPaths++;
+
+        // Get the cost of said path
+        unsigned int pathCap = pathCapacity(g, p);
+
+        // Increase our maximum flow by this capacity
+        maxFlow += pathCap;
+
+        // Residualize the graph / augment the flow
+        unsigned int vertex = g->vertices - 1;  // Start at the sink
+        while(vertex != 0){     // Repeat until we hit the source
+
+            // Recompute the residual
+            g->matrix[(p[vertex] * g->vertices) + vertex] -= pathCap;     // parent->self -= path flow
+            g->matrix[(vertex * g->vertices) + p[vertex]] += pathCap;     // self->parent += path flow
+            syncBit(g, bits, p[vertex], vertex);
+            syncBit(g, bits, vertex, p[vertex]);
+
+            // Augment the flow, first cancelling any flow running the other way
+            // (otherwise a path through a reverse residual edge would record flow on an edge that doesn't exist)
+            unsigned int *backFlow = &(f->matrix[(vertex * f->vertices) + p[vertex]]);
+            unsigned int cancelled = (*backFlow < pathCap) ? *backFlow : pathCap;
+            *backFlow -= cancelled;
+            f->matrix[(p[vertex] * f->vertices) + vertex] += pathCap - cancelled;
+
+            vertex = p[vertex]; // Move back along the path
+        }
+
+    }
+
+    scratchFree(g->scratch, p);
+    scratchFree(g->scratch, queue);
+    scratchFree(g->scratch, visited);
+    scratchFree(g->scratch, fresh);
+    scratchFree(g->scratch, bits);
+    if(stats != NULL) *stats = counts;
+    return maxFlow;
+}
+
+
+
+
+
+// Scratch space (see max_flow.h)
+void initScratch(flowscratch_t *scratch){
+    memset(scratch, 0, sizeof(flowscratch_t));
+}
+
+
+// Hands out bytes of scratch space (or of the heap, if scratch is NULL), aligned for any of the engines' arrays
+// Returns NULL if the heap is exhausted.
+void *scratchAlloc(flowscratch_t *scratch, size_t bytes){
+    if(scratch == NULL) return malloc(bytes);
+
+    bytes = (bytes + SCRATCH_ALIGNMENT - 1) & ~(size_t)(SCRATCH_ALIGNMENT - 1);
+    if(scratch->size - scratch->used >= bytes){
+        void *p = scratch->block + scratch->used;
+        scratch->used += bytes;
+        return p;
+    }
+
+    // The block is full; spill onto the heap until the next reset makes the block big enough
+    void *p = malloc(bytes);
+    if(p == NULL) return NULL;
+    if(scratch->spilledCount == scratch->spilledAllocated){
+        scratch->spilledAllocated = (scratch->spilledAllocated == 0) ? SCRATCH_INITIAL_SPILLS : 2 * scratch->spilledAllocated;
+        scratch->spilled = (void **)realloc(scratch->spilled, scratch->spilledAllocated * sizeof(void *));
+    }
+    scratch->spilled[scratch->spilledCount++] = p;
+    scratch->spilledBytes += bytes;
+    return p;
+}
+
+
+void *scratchCalloc(flowscratch_t *scratch, size_t count, size_t size){
+    if(scratch == NULL) return calloc(count, size);
+    void *p = scratchAlloc(scratch, count * size);
+    if(p != NULL) memset(p, 0, count * size);
+    return p;
+}
+
+
+// Scratch space is given back all at once by resetScratch(), so only heap allocations are freed here
+void scratchFree(flowscratch_t *scratch, void *p){
+    if(scratch == NULL) free(p);
+}
+
+
+// Gives back everything handed out since the last reset, growing the block to the total if it overflowed
+void resetScratch(flowscratch_t *scratch){
+    if(scratch->spilledCount != 0){
+        for(size_t i = 0; i < scratch->spilledCount; i++) free(scratch->spilled[i]);
+        size_t needed = scratch->used + scratch->spilledBytes;
+        free(scratch->block);
+        scratch->block = (char *)malloc(needed);
+        scratch->size = (scratch->block == NULL) ? 0 : needed;
+        scratch->spilledCount = 0;
+        scratch->spilledBytes = 0;
+    }
+    scratch->used = 0;
+}
+
+
+void freeScratch(flowscratch_t *scratch){
+    resetScratch(scratch);
+    free(scratch->block);
+    free(scratch->spilled);
+    initScratch(scratch);
+}
+
+
+
+// Adjacency matrix allocation: an all-zero matrix of the given number of vertices
+// Returns false (leaving g->matrix NULL) if the |V|^2 matrix cannot be allocated.
+bool allocMatrix(adjmatrix_t *g, size_t vertices, flowscratch_t *scratch){
+    g->vertices = vertices;
+    g->scratch = scratch;
+    g->matrix = (unsigned int *)scratchCalloc(scratch, vertices * vertices, sizeof(unsigned int));
+    return g->matrix != NULL;
+}
+
+
+void freeMatrix(adjmatrix_t *g){
+    scratchFree(g->scratch, g->matrix);
+}
+
+
+// Adjacency matrix construction
+// Returns false (leaving g->matrix NULL) if the |V|^2 matrix cannot be allocated.
+// O(|V|^2 + |E|) operation
+bool buildMatrix(edgelist_t *list, adjmatrix_t *g, flowscratch_t *scratch){
+    if(!allocMatrix(g, list->vertices, scratch)) return false;
+    for(size_t i = 0; i < list->count; i++){
+        edge_t *e = &(list->edges[i]);
+        g->matrix[(e->from * g->vertices) + e->to] += e->capacity;
+    }
+    return true;
+}
+
+
+// Residual network construction
+// Lays out the edges of the list as paired forward and reverse arcs in net.
+// O(|V| + |E|) operation
+void buildFlownet(edgelist_t *list, flownet_t *net, flowscratch_t *scratch){
+    size_t V = list->vertices;
+    net->vertices = V;
+    net->scratch = scratch;
+
+    // Count the arcs leaving each vertex (an edge u->v contributes one arc to u and one to v)
+    unsigned int *degree = (unsigned int *)scratchCalloc(scratch, V + 1, sizeof(unsigned int));
+    for(size_t i = 0; i < list->count; i++){
+        degree[list->edges[i].from]++;
+        degree[list->edges[i].to]++;
+    }
+
+    net->arcs = 2 * list->count;
+    net->first = (unsigned int *)scratchAlloc(scratch, (V + 1) * sizeof(unsigned int));
+    net->head = (unsigned int *)scratchAlloc(scratch, net->arcs * sizeof(unsigned int));
+    net->mate = (unsigned int *)scratchAlloc(scratch, net->arcs * sizeof(unsigned int));
+    net->capacity = (unsigned int *)scratchAlloc(scratch, net->arcs * sizeof(unsigned int));
+    net->residual = (unsigned int *)scratchAlloc(scratch, net->arcs * sizeof(unsigned int));
+    net->edgeArc = (unsigned int *)scratchAlloc(scratch, list->count * sizeof(unsigned int));
+
+    // Prefix-sum the degrees into arc offsets; degree[] is reused as each vertex's fill cursor
+    net->first[0] = 0;
+    for(size_t u = 0; u < V; u++){
+        net->first[u + 1] = net->first[u] + degree[u];
+        degree[u] = net->first[u];
+    }
+
+    // Place each edge and its reverse
+    for(size_t i = 0; i < list->count; i++){
+        edge_t *e = &(list->edges[i]);
+        unsigned int forward = degree[e->from]++;
+        unsigned int reverse = degree[e->to]++;
+        net->head[forward] = e->to;
+        net->head[reverse] = e->from;
+        net->mate[forward] = reverse;
+        net->mate[reverse] = forward;
+        net->capacity[forward] = e->capacity;
+        net->capacity[reverse] = 0;
+        net->residual[forward] = e->capacity;
+        net->residual[reverse] = 0;
+        net->edgeArc[i] = forward;
+    }
+
+    scratchFree(scratch, degree);
+}
+
+
+void freeFlownet(flownet_t *net){
+    scratchFree(net->scratch, net->first);
+    scratchFree(net->scratch, net->head);
+    scratchFree(net->scratch, net->mate);
+    scratchFree(net->scratch, net->capacity);
+    scratchFree(net->scratch, net->residual);
+    scratchFree(net->scratch, net->edgeArc);
+}
+
+
+
+
+
+// Dinic helper function: labels every vertex with its BFS distance from the source in the residual network
+// Returns true iff the sink is reachable. level[v] == -1 marks unreachable vertices.
+// O(|E|) operation
+bool dinicLevels(flownet_t *net, int *level, unsigned int *queue, flowstats_t *stats){
+    unsigned int sink = net->vertices - 1;
+    for(size_t v = 0; v < net->vertices; v++) level[v] = -1;
+
+    size_t qHead = 0, qTail = 0;
+    queue[qTail++] = 0;
+    level[0] = 0;
+    while(qHead < qTail){
+        unsigned int u = queue[qHead++];
+        for(unsigned int a = net->first[u]; a < net->first[u + 1]; a++){
+            unsigned int v = net->head[a];
+            if(net->residual[a] != 0 && level[v] < 0){
+                level[v] = level[u] + 1;
+                queue[qTail++] = v;
+            }
+        }
+        stats->edgeScans += net->first[u + 1] - net->first[u];
+    }
+    return level[sink] >= 0;
+}
+
+
+
+// Dinic's Algorithm
+// Parameters: net, the residual network to be operated upon; its residual capacities are consumed,
+//             and the flow on each forward arc is left as capacity - residual.
+//             stats, to be filled with operation counts (may be NULL)
+// Returns the maximal flow capacity.
+// Each phase builds a level graph by BFS and saturates it with a blocking flow, found by an iterative
+// DFS that keeps a current-arc pointer per vertex so that no dead arc is scanned twice in a phase.
+// O(|V|^2|E|) algorithm
+unsigned int dinic(flownet_t *net, flowstats_t *stats){
+    size_t V = net->vertices;
+    unsigned int sink = V - 1;
+    unsigned int maxFlow = 0;
+    flowstats_t counts = {0};
+
+    int *level = (int *)scratchAlloc(net->scratch, V * sizeof(int));
+    unsigned int *queue = (unsigned int *)scratchAlloc(net->scratch, V * sizeof(unsigned int));
+    unsigned int *current = (unsigned int *)scratchAlloc(net->scratch, V * sizeof(unsigned int));
+    unsigned int *path = (unsigned int *)scratchAlloc(net->scratch, V * sizeof(unsigned int));     // Arcs of the DFS path, source first
+
+    while(dinicLevels(net, level, queue, &counts)){
+        // While the sink is reachable, find a blocking flow in the level graph
+        memcpy(current, net->first, V * sizeof(unsigned int));
+
+        size_t depth = 0;
+        unsigned int vertex = 0;
+        while(true){
+            if(vertex == sink){
+                // Found an augmenting path; get its capacity...
+                unsigned int pathCap = net->residual[path[0]];
+                for(size_t i = 1; i < depth; i++){
+                    if(net->residual[path[i]] < pathCap) pathCap = net->residual[path[i]];
+                }
+
+                // ...residualize it...
+                size_t firstSaturated = depth;
+                for(size_t i = 0; i < depth; i++){
+                    net->residual[path[i]] -= pathCap;
+                    net->residual[net->mate[path[i]]] += pathCap;
+                    if(net->residual[path[i]] == 0 && firstSaturated == depth) firstSaturated = i;
+                }
+                maxFlow += pathCap;
+                counts.augmentingPaths++;
+
+                // ...and resume the search from the tail of the first saturated arc
+                depth = firstSaturated;
+                vertex = (depth == 0) ? 0 : net->head[path[depth - 1]];
+                continue;
+            }
+
+            // Advance along the current arc if it still leads one level deeper
+            unsigned int end = net->first[vertex + 1];
+            while(current[vertex] < end){
+                unsigned int a = current[vertex];
+                counts.edgeScans++;
+                if(net->residual[a] != 0 && level[net->head[a]] == level[vertex] + 1) break;
+                current[vertex]++;
+            }
+
+            if(current[vertex] < end){
+                path[depth++] = current[vertex];
+                vertex = net->head[current[vertex]];
+            } else {
+                // Dead end; remove the vertex from the level graph and retreat
+                level[vertex] = -1;
+                if(depth == 0) break;
+                depth--;
+                vertex = net->head[net->mate[path[depth]]];
+                current[vertex]++;
+            }
+        }
+    }
+
+    scratchFree(net->scratch, level);
+    scratchFree(net->scratch, queue);
+    scratchFree(net->scratch, current);
+    scratchFree(net->scratch, path);
+    if(stats != NULL) *stats = counts;
+    return maxFlow;
+}
+
+
+
+
+
+// Push-Relabel state, shared by the FIFO and highest-label selection rules
+typedef struct prstate {
+
+    flownet_t *net;
+    size_t V;
+    unsigned int *height;       // height[v] is the distance label of v (always < 2|V|)
+    long long *excess;          // excess[v] is the inflow of v less its outflow
+    unsigned int *current;      // current[v] is the current-arc pointer of v
+    unsigned int *count;        // count[h] is the number of vertices with height h
+    unsigned int *queue;        // Scratch space for global relabelling
+    size_t workSinceRelabel;    // Arc scans performed since the last global relabel
+    flowstats_t counts;         // Operation counts so far
+
+} prstate_t;
+
+
+// Push-Relabel helper function: recomputes exact distance labels by reverse BFS.
+// Vertices that can reach the sink are labelled with their residual distance to it, those that can only
+// reach the source with |V| + their distance to it, and the rest (which can hold no excess) with 2|V| - 1.
+// O(|E|) operation
+void globalRelabel(prstate_t *s){
+    flownet_t *net = s->net;
+    size_t V = s->V;
+    unsigned int unlabelled = 2 * V - 1;
+
+    for(size_t v = 0; v < V; v++) s->height[v] = unlabelled;
+    s->height[0] = V;   // The source's label is fixed; it must not be reached from the sink
+    memset(s->count, 0, 2 * V * sizeof(unsigned int));
+
+    // Two passes: the first grows from the sink, the second from the source
+    unsigned int roots[2] = {V - 1, 0};
+    unsigned int rootHeights[2] = {0, V};
+    for(int pass = 0; pass < 2; pass++){
+        size_t qHead = 0, qTail = 0;
+        s->height[roots[pass]] = rootHeights[pass];
+        s->queue[qTail++] = roots[pass];
+        while(qHead < qTail){
+            unsigned int u = s->queue[qHead++];
+            for(unsigned int a = net->first[u]; a < net->first[u + 1]; a++){
+                // w may reach u if the arc w->u (the mate of u->w) has residual capacity
+                unsigned int w = net->head[a];
+                if(s->height[w] == unlabelled && net->residual[net->mate[a]] != 0){
+                    s->height[w] = s->height[u] + 1;
+                    s->queue[qTail++] = w;
+                }
+            }
+            s->counts.edgeScans += net->first[u + 1] - net->first[u];
+        }
+    }
+
+    for(size_t v = 0; v < V; v++){
+        s->count[s->height[v]]++;
+        s->current[v] = net->first[v];
+    }
+    s->workSinceRelabel = 0;
+}
+
+
+// Push-Relabel helper function: lifts vertex u just above its lowest residual neighbour.
+// Applies the gap heuristic: if u was the last vertex at its old height below |V|, no vertex above the gap
+// can reach the sink any longer, so they are all lifted to |V| at once.
+void relabel(prstate_t *s, unsigned int u){
+    flownet_t *net = s->net;
+    size_t V = s->V;
+    unsigned int oldHeight = s->height[u];
+
+    unsigned int newHeight = 2 * V - 1;
+    for(unsigned int a = net->first[u]; a < net->first[u + 1]; a++){
+        if(net->residual[a] != 0 && s->height[net->head[a]] + 1 < newHeight){
+            newHeight = s->height[net->head[a]] + 1;
+            s->current[u] = a;
+        }
+    }
+    s->workSinceRelabel += 12 + (net->first[u + 1] - net->first[u]);
+    s->counts.edgeScans += net->first[u + 1] - net->first[u];
+    s->counts.relabels++;
+
+    s->count[oldHeight]--;
+    s->height[u] = newHeight;
+    s->count[newHeight]++;
+
+    if(s->count[oldHeight] == 0 && oldHeight < V){
+        for(size_t v = 0; v < V; v++){
+            if(s->height[v] > oldHeight && s->height[v] < V){
+                s->count[s->height[v]]--;
+                s->height[v] = V;
+                s->count[V]++;
+                s->current[v] = net->first[v];
+            }
+        }
+    }
+}
+
+
+// Push-Relabel helper function: prepares the state and saturates every arc leaving the source
+void initPushRelabel(prstate_t *s, flownet_t *net){
+    size_t V = net->vertices;
+    s->net = net;
+    s->V = V;
+    s->height = (unsigned int *)scratchAlloc(s->net->scratch, V * sizeof(unsigned int));
+    s->excess = (long long *)scratchCalloc(s->net->scratch, V, sizeof(long long));
+    s->current = (unsigned int *)scratchAlloc(s->net->scratch, V * sizeof(unsigned int));
+    s->count = (unsigned int *)scratchAlloc(s->net->scratch, 2 * V * sizeof(unsigned int));
+    s->queue = (unsigned int *)scratchAlloc(s->net->scratch, V * sizeof(unsigned int));
+    memset(&(s->counts), 0, sizeof(flowstats_t));
+
+    for(unsigned int a = net->first[0]; a < net->first[1]; a++){
+        unsigned int delta = net->residual[a];
+        net->residual[a] = 0;
+        net->residual[net->mate[a]] += delta;
+        s->excess[net->head[a]] += delta;
+        s->excess[0] -= delta;
+    }
+
+    globalRelabel(s);
+}
+
+
+void freePushRelabel(prstate_t *s){
+    scratchFree(s->net->scratch, s->height);
+    scratchFree(s->net->scratch, s->excess);
+    scratchFree(s->net->scratch, s->current);
+    scratchFree(s->net->scratch, s->count);
+    scratchFree(s->net->scratch, s->queue);
+}
+
+
+// Push-Relabel helper function: whether a global relabel is due
+// (the usual threshold of a few relabels' worth of work per vertex plus one pass over the arcs)
+bool globalRelabelDue(prstate_t *s){
+    return s->workSinceRelabel > 6 * s->V + s->net->arcs / 2;
+}
+
+
+
+// Push-Relabel Algorithm with FIFO vertex selection
+// Parameters: net, stats; as for dinic() above
+// Returns the maximal flow capacity.
+// Active vertices wait in a ring buffer and are each discharged fully before the next is taken.
+// Uses the gap and global relabelling heuristics; the second phase (returning stranded excess to the
+// source) falls out of letting heights rise above |V|, so the result is a valid flow and not just a preflow.
+// O(|V|^3) algorithm
+unsigned int pushRelabelFIFO(flownet_t *net, flowstats_t *stats){
+    prstate_t s;
+    initPushRelabel(&s, net);
+    size_t V = s.V;
+    unsigned int sink = V - 1;
+
+    // Each vertex is queued at most once at a time, so a ring of |V| slots suffices
+    unsigned int *ring = (unsigned int *)scratchAlloc(net->scratch, V * sizeof(unsigned int));
+    bool *queued = (bool *)scratchCalloc(net->scratch, V, sizeof(bool));
+    size_t ringHead = 0, ringSize = 0;
+    for(unsigned int v = 1; v < sink; v++){
+        if(s.excess[v] > 0){
+            ring[(ringHead + ringSize++) % V] = v;
+            queued[v] = true;
+        }
+    }
+
+    while(ringSize > 0){
+        unsigned int u = ring[ringHead];
+        ringHead = (ringHead + 1) % V;
+        ringSize--;
+        queued[u] = false;
+
+        // Discharge u
+        while(s.excess[u] > 0){
+            if(s.current[u] == net->first[u + 1]){
+                relabel(&s, u);
+                if(s.height[u] >= 2 * V - 1) break;     // Unreachable from anywhere; cannot occur with a valid labelling
+                continue;
+            }
+            unsigned int a = s.current[u];
+            unsigned int v = net->head[a];
+            s.counts.edgeScans++;
+            if(net->residual[a] != 0 && s.height[u] == s.height[v] + 1){
+                unsigned int delta = (s.excess[u] < net->residual[a]) ? (unsigned int)s.excess[u] : net->residual[a];
+                net->residual[a] -= delta;
+                net->residual[net->mate[a]] += delta;
+                s.excess[u] -= delta;
+                s.excess[v] += delta;
+                s.counts.pushes++;
+                if(v != 0 && v != sink && !queued[v]){
+                    ring[(ringHead + ringSize++) % V] = v;
+                    queued[v] = true;
+                }
+            } else {
+                s.current[u]++;
+            }
+        }
+
+        if(globalRelabelDue(&s)) globalRelabel(&s);
+    }
+
+    unsigned int maxFlow = (unsigned int)s.excess[sink];
+    if(stats != NULL) *stats = s.counts;
+    scratchFree(net->scratch, ring);
+    scratchFree(net->scratch, queued);
+    freePushRelabel(&s);
+    return maxFlow;
+}
+
+
+
+// Highest-label helper function: files every active vertex into the bucket for its height
+// Returns the highest height holding an active vertex.
+size_t fileActive(prstate_t *s, unsigned int *bucket, unsigned int *next, bool *active){
+    size_t V = s->V;
+    size_t highest = 0;
+    for(size_t h = 0; h < 2 * V; h++) bucket[h] = V;
+    for(unsigned int v = 1; v < V - 1; v++){
+        active[v] = (s->excess[v] > 0);
+        if(active[v]){
+            next[v] = bucket[s->height[v]];
+            bucket[s->height[v]] = v;
+            if(s->height[v] > highest) highest = s->height[v];
+        }
+    }
+    return highest;
+}
+
+
+// Push-Relabel Algorithm with highest-label vertex selection
+// Parameters: net, stats; as for dinic() above
+// Returns the maximal flow capacity.
+// Active vertices are bucketed by height and the highest is always discharged next.
+// Heuristics and phases as for pushRelabelFIFO() above.
+// O(|V|^2 sqrt(|E|)) algorithm
+unsigned int pushRelabelHighest(flownet_t *net, flowstats_t *stats){
+    prstate_t s;
+    initPushRelabel(&s, net);
+    size_t V = s.V;
+    unsigned int sink = V - 1;
+
+    // Singly-linked active lists, one per height; next[v] == V terminates a list
+    unsigned int *bucket = (unsigned int *)scratchAlloc(net->scratch, 2 * V * sizeof(unsigned int));
+    unsigned int *next = (unsigned int *)scratchAlloc(net->scratch, V * sizeof(unsigned int));
+    bool *active = (bool *)scratchCalloc(net->scratch, V, sizeof(bool));
+
+    size_t highest = fileActive(&s, bucket, next, active);
+
+    while(true){
+        // Find the highest non-empty bucket
+        while(highest > 0 && bucket[highest] == V) highest--;
+        if(bucket[highest] == V) break;
+
+        unsigned int u = bucket[highest];
+        bucket[highest] = next[u];
+
+        // The height of u may have been raised by a gap relabel since it was filed; refile it if so
+        if(s.height[u] != highest){
+            next[u] = bucket[s.height[u]];
+            bucket[s.height[u]] = u;
+            if(s.height[u] > highest) highest = s.height[u];
+            continue;
+        }
+        active[u] = false;
+
+        // Discharge u
+        while(s.excess[u] > 0){
+            if(s.current[u] == net->first[u + 1]){
+                relabel(&s, u);
+                if(s.height[u] >= 2 * V - 1) break;
+                continue;
+            }
+            unsigned int a = s.current[u];
+            unsigned int v = net->head[a];
+            s.counts.edgeScans++;
+            if(net->residual[a] != 0 && s.height[u] == s.height[v] + 1){
+                unsigned int delta = (s.excess[u] < net->residual[a]) ? (unsigned int)s.excess[u] : net->residual[a];
+                net->residual[a] -= delta;
+                net->residual[net->mate[a]] += delta;
+                s.excess[u] -= delta;
+                s.excess[v] += delta;
+                s.counts.pushes++;
+                if(v != 0 && v != sink && !active[v]){
+                    next[v] = bucket[s.height[v]];
+                    bucket[s.height[v]] = v;
+                    active[v] = true;
+                }
+            } else {
+                s.current[u]++;
+            }
+        }
+        // u may have climbed above the old maximum, and pushed just below itself
+        if(s.height[u] > highest) highest = s.height[u];
+
+        if(globalRelabelDue(&s)){
+            // Exact labels may move vertices either way; refile everything
+            globalRelabel(&s);
+            highest = fileActive(&s, bucket, next, active);
+        }
+    }
+
+    unsigned int maxFlow = (unsigned int)s.excess[sink];
+    if(stats != NULL) *stats = s.counts;
+    scratchFree(net->scratch, bucket);
+    scratchFree(net->scratch, next);
+    scratchFree(net->scratch, active);
+    freePushRelabel(&s);
+    return maxFlow;
+}
+
+
+
+
+
+// Warm-start helper: breadth-first search through the residual network from start for a vertex
+// that can absorb (or, searching backwards, supply) the imbalance at start: the source, the sink,
+// or a vertex whose imbalance is of the opposite sign.
+// Searching forwards follows arcs with residual capacity; backwards, arcs whose mates have it.
+// On success returns the vertex found, with via[v] the arc (in the direction flow will move)
+// by which each vertex of the path was reached. Returns start if there is no such vertex.
+unsigned int findBalancingPath(flownet_t *net, unsigned int start, bool forwards, long long *excess,
+                               unsigned int *via, unsigned int *queue, bool *visited, flowstats_t *stats){
+    size_t V = net->vertices;
+    memset(visited, 0, V * sizeof(bool));
+
+    size_t qHead = 0, qTail = 0;
+    queue[qTail++] = start;
+    visited[start] = true;
+    while(qHead < qTail){
+        unsigned int u = queue[qHead++];
+        for(unsigned int a = net->first[u]; a < net->first[u + 1]; a++){
+            unsigned int w = net->head[a];
+            unsigned int arc = forwards ? a : net->mate[a];
+            if(visited[w] || net->residual[arc] == 0) continue;
+            visited[w] = true;
+            via[w] = arc;
+            if(w == 0 || w == V - 1 || (forwards ? excess[w] < 0 : excess[w] > 0)) return w;
+            queue[qTail++] = w;
+        }
+        stats->edgeScans += net->first[u + 1] - net->first[u];
+    }
+    return start;
+}
+
+
+// Marks a vertex with no arc to it from the tail being laid, in repairFlow()
+#define NO_ARC UINT_MAX
+
+// Warm Start
+// Parameters: net, a residual network freshly built from the (changed) network
+//             previous, a flow found for the network before its capacities changed (each edge's capacity field
+//             holding its flow, as read by readFlows())
+//             stats, to be filled with operation counts (may be NULL)
+// Returns true iff the previous flow could be repaired into a valid flow on net, which is left holding it.
+// The previous flow is laid onto net with each edge's flow cut down to its new capacity. Every cut leaves
+// surplus inflow at the edge's tail and a shortfall at its head; each surplus is routed along residual paths
+// to a shortfall or back to the source (or on to the sink), and each remaining shortfall is then made up from
+// the source (or by drawing back flow from the sink). Capacities that grew are left to the engine run afterwards,
+// which can augment from the repaired flow rather than from zero.
+bool repairFlow(flownet_t *net, edgelist_t *previous, flowstats_t *stats){
+    size_t V = net->vertices;
+    flowstats_t counts = {0};
+    long long *excess = (long long *)scratchCalloc(net->scratch, V, sizeof(long long));
+
+    // Lay the previous flow onto the network, a tail at a time: the previous edges are bucketed by tail, and the
+    // tail's forward arcs indexed by head in arcTo[], so that each edge finds its arc in O(1) rather than by a
+    // scan of its tail's arcs (which would be quadratic in the degree of a busy source or sink)
+    size_t *bucket = (size_t *)scratchCalloc(net->scratch, V + 1, sizeof(size_t));
+    size_t *order = (size_t *)scratchAlloc(net->scratch, previous->count * sizeof(size_t));
+    unsigned int *arcTo = (unsigned int *)scratchAlloc(net->scratch, V * sizeof(unsigned int));
+    for(size_t v = 0; v < V; v++) arcTo[v] = NO_ARC;
+    for(size_t i = 0; i < previous->count; i++){
+        if(previous->edges[i].from < V) bucket[previous->edges[i].from + 1]++;
+    }
+    for(size_t v = 0; v < V; v++) bucket[v + 1] += bucket[v];
+    for(size_t i = 0; i < previous->count; i++){
+        edge_t *e = &(previous->edges[i]);
+        if(e->from < V){
+            order[bucket[e->from]++] = i;
+        } else if(e->to < V){
+            // An edge from a vertex the network no longer has went away
+            excess[e->to] -= e->capacity;
+        }
+    }
+
+    size_t next = 0;
+    for(size_t u = 0; u < V; u++){
+        if(next == bucket[u]) continue;
+        for(unsigned int a = net->first[u]; a < net->first[u + 1]; a++){
+            if(net->capacity[a] != 0) arcTo[net->head[a]] = a;
+        }
+        for(; next < bucket[u]; next++){
+            edge_t *e = &(previous->edges[order[next]]);
+            unsigned int flow = e->capacity;
+            unsigned int kept = 0;
+            unsigned int a = (e->to < V) ? arcTo[e->to] : NO_ARC;
+            if(a != NO_ARC){
+                kept = (flow < net->residual[a]) ? flow : net->residual[a];
+                net->residual[a] -= kept;
+                net->residual[net->mate[a]] += kept;
+            }
+            if(kept < flow){
+                // The edge shrank or went away
+                excess[e->from] += flow - kept;
+                if(e->to < V) excess[e->to] -= flow - kept;
+            }
+        }
+        for(unsigned int a = net->first[u]; a < net->first[u + 1]; a++) arcTo[net->head[a]] = NO_ARC;
+    }
+    scratchFree(net->scratch, bucket);
+    scratchFree(net->scratch, order);
+    scratchFree(net->scratch, arcTo);
+
+    unsigned int *via = (unsigned int *)scratchAlloc(net->scratch, V * sizeof(unsigned int));
+    unsigned int *queue = (unsigned int *)scratchAlloc(net->scratch, V * sizeof(unsigned int));
+    bool *visited = (bool *)scratchAlloc(net->scratch, V * sizeof(bool));
+    bool repaired = true;
+
+    // Surpluses first, then shortfalls
+    for(int pass = 0; pass < 2 && repaired; pass++){
+        bool forwards = (pass == 0);
+        for(unsigned int v = 1; v < V - 1 && repaired; v++){
+            while(forwards ? excess[v] > 0 : excess[v] < 0){
+                unsigned int end = findBalancingPath(net, v, forwards, excess, via, queue, visited, &counts);
+                if(end == v){
+                    repaired = false;
+                    break;
+                }
+
+                // Move as much as the path, the imbalance at v and any opposite imbalance at its end allow
+                long long amount = forwards ? excess[v] : -excess[v];
+                if(end != 0 && end != V - 1){
+                    long long opposite = forwards ? -excess[end] : excess[end];
+                    if(opposite < amount) amount = opposite;
+                }
+                for(unsigned int w = end; w != v; ){
+                    unsigned int arc = via[w];
+                    if(net->residual[arc] < amount) amount = net->residual[arc];
+                    w = forwards ? net->head[net->mate[arc]] : net->head[arc];
+                }
+                for(unsigned int w = end; w != v; ){
+                    unsigned int arc = via[w];
+                    net->residual[arc] -= amount;
+                    net->residual[net->mate[arc]] += amount;
+                    w = forwards ? net->head[net->mate[arc]] : net->head[arc];
+                }
+                excess[v] += forwards ? -amount : amount;
+                excess[end] += forwards ? amount : -amount;
+                counts.augmentingPaths++;
+            }
+        }
+    }
+
+    scratchFree(net->scratch, excess);
+    scratchFree(net->scratch, via);
+    scratchFree(net->scratch, queue);
+    scratchFree(net->scratch, visited);
+    if(stats != NULL) *stats = counts;
+    return repaired;
+}
+
+
+// The value of the flow net holds: the net flow out of the source along its forward arcs
+unsigned int flowValue(flownet_t *net){
+    long long value = 0;
+    for(size_t u = 0; u < net->vertices; u++){
+        for(unsigned int a = net->first[u]; a < net->first[u + 1]; a++){
+            if(net->capacity[a] == 0) continue;
+            long long flow = net->capacity[a] - net->residual[a];
+            if(u == 0) value += flow;
+            if(net->head[a] == 0) value -= flow;
+        }
+    }
+    return (unsigned int)value;
+}
+
+
+
+// Terminal relabelling
+// The engines take vertex 0 as the source and |V| - 1 as the sink, so a flow between other vertices is computed
+// with the network's vertex numbers permuted: source and 0 are swapped, and then sink (wherever that swap left it)
+// and |V| - 1. Edges keep their places in the list, so a flow found this way maps back edge for edge.
+unsigned int swapVertices(unsigned int v, unsigned int a, unsigned int b){
+    return (v == a) ? b : ((v == b) ? a : v);
+}
+
+
+// The number vertex v takes when source and sink are relabelled (or, if inverse, the number it had before)
+unsigned int terminalRelabel(unsigned int v, unsigned int source, unsigned int sink, size_t V, bool inverse){
+    unsigned int sinkAfterSwap = swapVertices(sink, source, 0);
+    if(inverse) return swapVertices(swapVertices(v, sinkAfterSwap, V - 1), source, 0);
+    return swapVertices(swapVertices(v, source, 0), sinkAfterSwap, V - 1);
+}
+
+
+// Relabels every edge of list in place (or, if inverse, undoes that)
+void relabelTerminals(edgelist_t *list, unsigned int source, unsigned int sink, bool inverse){
+    for(size_t i = 0; i < list->count; i++){
+        list->edges[i].from = terminalRelabel(list->edges[i].from, source, sink, list->vertices, inverse);
+        list->edges[i].to = terminalRelabel(list->edges[i].to, source, sink, list->vertices, inverse);
+    }
+}
@@ -0,0 +1,152 @@
+#ifndef MAX_FLOW_H
+#define MAX_FLOW_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/* max_flow.h
+ *
+ * Flow network representations and the maximum flow engines shared by
+ * the flow network programs.
+ * Source is vertex zero and Sink is vertex |V| - 1, as in the assignment.
+ */
+
+
+// Scratch space, for callers that solve many networks in turn (e.g. one thread of a batch).
+// Networks built in scratch space take their arrays from it, and so do the engines run on them, instead of
+// allocating and freeing their own; the space is only handed back by resetScratch(), between networks.
+// Its block grows to the most any one network has needed, after which solving allocates nothing.
+typedef struct flowscratch {
+
+    char *block;                // The block space is handed out from
+    size_t size;                // Its size in bytes
+    size_t used;                // Bytes handed out from it since the last reset
+    void **spilled;             // Allocations made on the heap since the last reset, because the block was full
+    size_t spilledCount;
+    size_t spilledAllocated;
+    size_t spilledBytes;        // Their total size
+
+} flowscratch_t;
+
+
+// An Adjacency Matrix
+typedef struct adjmatrix {
+
+    size_t vertices;            // The number of vertices in the graph
+    unsigned int *matrix;       // matrix[(u * vertices) + v] is the capacity of edge u->v (0 == no edge)
+    flowscratch_t *scratch;     // The scratch space the matrix came from (NULL if from the heap)
+
+} adjmatrix_t;
+
+
+// An edge of a flow network, with its endpoints numbered from zero
+typedef struct edge {
+
+    unsigned int from;
+    unsigned int to;
+    unsigned int capacity;
+
+} edge_t;
+
+
+// An Edge List; the form in which networks are read, and from which the other representations are built
+typedef struct edgelist {
+
+    size_t vertices;            // The number of vertices in the network
+    size_t count;               // The number of edges
+    size_t allocated;           // The number of edges there is space for
+    edge_t *edges;
+
+} edgelist_t;
+
+
+// A Residual Network in compressed adjacency form
+// Every edge u->v of the network becomes a forward arc paired with a reverse arc v->u,
+// so that flow pushed along one can be cancelled along the other. The arcs leaving
+// vertex u are stored contiguously at indices first[u] .. first[u + 1] - 1.
+typedef struct flownet {
+
+    size_t vertices;            // The number of vertices in the network
+    size_t arcs;                // The number of arcs (twice the number of edges)
+    unsigned int *first;        // first[u] is the index of the first arc leaving u; first[vertices] == arcs
+    unsigned int *head;         // head[a] is the vertex arc a points to
+    unsigned int *mate;         // mate[a] is the arc running opposite to arc a
+    unsigned int *capacity;     // capacity[a] is the capacity of arc a (0 for reverse arcs)
+    unsigned int *residual;     // residual[a] is the remaining capacity of arc a
+    unsigned int *edgeArc;      // edgeArc[i] is the forward arc of edge i of the edge list the network was built from
+    flowscratch_t *scratch;     // The scratch space the arrays came from (NULL if from the heap)
+
+} flownet_t;
+
+
+// Operation counts reported by the engines
+typedef struct flowstats {
+
+    unsigned long long augmentingPaths;     // Augmenting paths found (Edmonds-Karp, Dinic)
+    unsigned long long pushes;              // Push operations (Push-Relabel)
+    unsigned long long relabels;            // Relabel operations, global relabels excluded (Push-Relabel)
+    unsigned long long edgeScans;           // Arcs (or matrix cells) inspected while searching
+
+} flowstats_t;
+
+
+// Scratch space
+void initScratch(flowscratch_t *scratch);
+void *scratchAlloc(flowscratch_t *scratch, size_t bytes);
+void *scratchCalloc(flowscratch_t *scratch, size_t count, size_t size);
+void scratchFree(flowscratch_t *scratch, void *p);
+void resetScratch(flowscratch_t *scratch);
+void freeScratch(flowscratch_t *scratch);
+
+
+// Network construction
+// Each takes its arrays from scratch, or from the heap if scratch is NULL.
+bool allocMatrix(adjmatrix_t *g, size_t vertices, flowscratch_t *scratch);
+bool buildMatrix(edgelist_t *list, adjmatrix_t *g, flowscratch_t *scratch);
+void freeMatrix(adjmatrix_t *g);
+void buildFlownet(edgelist_t *list, flownet_t *net, flowscratch_t *scratch);
+void freeFlownet(flownet_t *net);
+
+
+// Maximum flow engines
+// Each returns the value of the maximum flow from source to sink, and fills stats (if not NULL) with its operation counts.
+// Each takes its working space from the scratch space the network was built in, if any.
+unsigned int edmondsKarp(adjmatrix_t *g, adjmatrix_t *f, flowstats_t *stats);
+unsigned int dinic(flownet_t *net, flowstats_t *stats);
+unsigned int pushRelabelFIFO(flownet_t *net, flowstats_t *stats);
+unsigned int pushRelabelHighest(flownet_t *net, flowstats_t *stats);
+
+// Warm starting from a flow found before capacities changed; an engine run afterwards augments the repaired
+// flow, and returns only the flow it adds.
+bool repairFlow(flownet_t *net, edgelist_t *previous, flowstats_t *stats);
+unsigned int flowValue(flownet_t *net);
+
+// Other terminals: the engines' source and sink are vertices 0 and |V| - 1, so a flow between any other pair is
+// found by relabelling the network, swapping source with 0 and then sink with |V| - 1.
+unsigned int terminalRelabel(unsigned int v, unsigned int source, unsigned int sink, size_t vertices, bool inverse);
+void relabelTerminals(edgelist_t *list, unsigned int source, unsigned int sink, bool inverse);
+
+// Multithreaded engine (parallel_max_flow.c)
+unsigned int pushRelabelParallel(flownet_t *net, flowstats_t *stats, unsigned int threads);
+
+
+// A Gomory-Hu Tree: for every pair of vertices, the minimum cut between them in the network (taken as undirected)
+// is the least weight on the tree path joining them. Vertex 0 is the root.
+typedef struct cuttree {
+
+    size_t vertices;
+    unsigned int *parent;       // parent[v] is v's parent (parent[0] == 0)
+    unsigned int *weight;       // weight[v] is the minimum cut between v and its parent
+    unsigned int *depth;        // depth[v] is the number of tree edges between v and the root
+
+} cuttree_t;
+
+// The single-threaded engines that work on a flownet_t
+typedef unsigned int (*flowengine_t)(flownet_t *net, flowstats_t *stats);
+
+// Gomory-Hu trees (gomory_hu.c)
+void gomoryHuTree(edgelist_t *list, cuttree_t *tree, flowengine_t engine, unsigned int threads);
+unsigned int minimumCut(cuttree_t *tree, unsigned int u, unsigned int v);
+void freeCuttree(cuttree_t *tree);
+
+#endif
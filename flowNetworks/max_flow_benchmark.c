@@ -0,0 +1,272 @@
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "flow_gen.h"
+#include "flow_io.h"
+#include "max_flow.h"
+
+/* max_flow_benchmark.c
+ *
+ * Runs every maximum flow engine over suites of generated networks of
+ * increasing size, checks that they agree, and reports their costs as CSV.
+ */
+
+
+// Suite controls
+// Smallest and largest number of vertices; each size is SIZE_STEP times the last
+#define DEFAULT_MIN_VERTICES 256
+#define DEFAULT_MAX_VERTICES 16384
+#define SIZE_STEP 4
+
+// Networks (seeds) per family and size
+#define DEFAULT_SEEDS 3
+
+// Edges per vertex, and largest capacity, of the generated networks
+#define DEFAULT_EDGES_PER_VERTEX 8
+#define DEFAULT_MAX_CAPACITY 100
+
+// Edmonds-Karp works on an adjacency matrix, and is skipped on networks with more vertices than this
+#define DEFAULT_EDMONDS_KARP_LIMIT 4096
+
+// Longest line expected in /proc/self/status
+#define STATUS_LINE_LENGTH 256
+
+
+// The engines, in the order they are run and reported
+typedef enum engine {
+
+    ENGINE_EDMONDS_KARP,
+    ENGINE_DINIC,
+    ENGINE_FIFO,
+    ENGINE_HIGHEST,
+    ENGINE_PARALLEL
+
+} engine_t;
+
+const char *engineNames[] = {"edmonds-karp", "dinic", "fifo", "highest", "parallel"};
+#define ENGINE_COUNT (sizeof(engineNames) / sizeof(engineNames[0]))
+
+
+// The cost of one engine's run over one network
+typedef struct measurement {
+
+    unsigned int maxFlow;
+    double buildSeconds;        // Building the engine's representation from the edge list
+    double solveSeconds;        // Running the engine
+    flowstats_t stats;
+    long peakKilobytes;         // Peak resident set size while building and solving (-1 if unknown)
+
+} measurement_t;
+
+
+
+// Seconds on the monotonic clock
+double now(void){
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + (t.tv_nsec / 1e9);
+}
+
+
+// Peak RSS helpers
+// Linux lets a process reset its peak resident set size by writing 5 to /proc/self/clear_refs, and reports it
+// as VmHWM in /proc/self/status, so each engine's peak can be measured in turn within the one process.
+// Elsewhere, the process's lifetime peak from getrusage() stands in (and can only grow from engine to engine).
+void resetPeakRSS(void){
+    FILE *fp = fopen("/proc/self/clear_refs", "w");
+    if(fp == NULL) return;
+    fputs("5", fp);
+    fclose(fp);
+}
+
+long peakRSS(void){
+    FILE *fp = fopen("/proc/self/status", "r");
+    if(fp != NULL){
+        char line[STATUS_LINE_LENGTH];
+        long kilobytes = -1;
+        while(fgets(line, STATUS_LINE_LENGTH, fp)){
+            if(strncmp(line, "VmHWM:", 6) == 0){
+                kilobytes = atol(line + 6);
+                break;
+            }
+        }
+        fclose(fp);
+        if(kilobytes >= 0) return kilobytes;
+    }
+
+    struct rusage usage;
+    if(getrusage(RUSAGE_SELF, &usage) != 0) return -1;
+    return usage.ru_maxrss;
+}
+
+
+
+// Builds the representation engine works on from edges, runs it, and measures the run
+void runEngine(engine_t engine, edgelist_t *edges, unsigned int threads, measurement_t *m){
+    memset(m, 0, sizeof(measurement_t));
+    resetPeakRSS();
+
+    double start = now();
+    if(engine == ENGINE_EDMONDS_KARP){
+        adjmatrix_t residual, flow;
+        if(!buildMatrix(edges, &residual, NULL)){
+            fprintf(stderr, "%zu vertices is too many for an adjacency matrix\n", edges->vertices);
+            exit(4);
+        }
+        allocMatrix(&flow, residual.vertices, NULL);
+        double built = now();
+        m->maxFlow = edmondsKarp(&residual, &flow, &(m->stats));
+        m->solveSeconds = now() - built;
+        m->buildSeconds = built - start;
+        m->peakKilobytes = peakRSS();
+        freeMatrix(&residual);
+        freeMatrix(&flow);
+    } else {
+        flownet_t net;
+        buildFlownet(edges, &net, NULL);
+        double built = now();
+        if(engine == ENGINE_DINIC){
+            m->maxFlow = dinic(&net, &(m->stats));
+        } else if(engine == ENGINE_FIFO){
+            m->maxFlow = pushRelabelFIFO(&net, &(m->stats));
+        } else if(engine == ENGINE_HIGHEST){
+            m->maxFlow = pushRelabelHighest(&net, &(m->stats));
+        } else {
+            m->maxFlow = pushRelabelParallel(&net, &(m->stats), threads);
+        }
+        m->solveSeconds = now() - built;
+        m->buildSeconds = built - start;
+        m->peakKilobytes = peakRSS();
+        freeFlownet(&net);
+    }
+}
+
+
+
+// Main Function
+// Program takes no arguments. For every family of network (see flow_gen.h), every size from the smallest to the
+// largest, and every seed, it generates a network and runs every engine over it, writing one CSV row per run to
+// standard output. The maximum flows found for each network must agree; the program exits with status 3 if they
+// ever do not (having reported which on stderr), so it also serves as a regression test.
+// Options:
+//   -f limits the run to one family (repeatable)
+//   -a limits the run to one engine (repeatable)
+//   -n and -N set the smallest and largest number of vertices
+//   -r sets the number of seeds per family and size (seeds run from 1)
+//   -m sets the number of edges per vertex, and -c the largest capacity
+//   -e sets the most vertices Edmonds-Karp is run on
+//   -j sets the number of threads for the parallel engine (one per online processor by default)
+int main(int argc, char **argv){
+
+    // Parse options
+    bool families[FAMILY_COUNT] = {false};
+    bool engines[ENGINE_COUNT] = {false};
+    bool anyFamily = false, anyEngine = false;
+    size_t minVertices = DEFAULT_MIN_VERTICES;
+    size_t maxVertices = DEFAULT_MAX_VERTICES;
+    unsigned long seeds = DEFAULT_SEEDS;
+    size_t edgesPerVertex = DEFAULT_EDGES_PER_VERTEX;
+    unsigned int maxCapacity = DEFAULT_MAX_CAPACITY;
+    size_t edmondsKarpLimit = DEFAULT_EDMONDS_KARP_LIMIT;
+    long threads = sysconf(_SC_NPROCESSORS_ONLN);
+    int opt;
+    while((opt = getopt(argc, argv, "a:c:e:f:j:m:n:N:r:")) != -1){
+        if(opt == 'f'){
+            size_t f = 0;
+            while(f < FAMILY_COUNT && strcmp(optarg, familyNames[f]) != 0) f++;
+            if(f == FAMILY_COUNT){
+                fprintf(stderr, "Unknown topology %s (expected random, layered, grid, bipartite or adversarial)\n", optarg);
+                exit(1);
+            }
+            families[f] = anyFamily = true;
+        } else if(opt == 'a'){
+            size_t e = 0;
+            while(e < ENGINE_COUNT && strcmp(optarg, engineNames[e]) != 0) e++;
+            if(e == ENGINE_COUNT){
+                fprintf(stderr, "Unknown engine %s (expected edmonds-karp, dinic, fifo, highest or parallel)\n", optarg);
+                exit(1);
+            }
+            engines[e] = anyEngine = true;
+        } else if(opt == 'n'){
+            minVertices = strtoull(optarg, NULL, 10);
+        } else if(opt == 'N'){
+            maxVertices = strtoull(optarg, NULL, 10);
+        } else if(opt == 'r'){
+            seeds = strtoul(optarg, NULL, 10);
+        } else if(opt == 'm'){
+            edgesPerVertex = strtoull(optarg, NULL, 10);
+        } else if(opt == 'c'){
+            maxCapacity = (unsigned int)strtoul(optarg, NULL, 10);
+        } else if(opt == 'e'){
+            edmondsKarpLimit = strtoull(optarg, NULL, 10);
+        } else if(opt == 'j'){
+            threads = atol(optarg);
+        } else {
+            argc = 0;   // Fall through to the usage message
+            break;
+        }
+    }
+
+    // Verify arguments
+    if(argc - optind != 0 || minVertices < 4 || maxVertices < minVertices || maxCapacity < 1 || threads < 1){
+        fprintf(stderr, "Usage: max_flow_benchmark [-f family]... [-a engine]... [-n min vertices] [-N max vertices] [-r seeds] [-m edges per vertex] [-c capacity] [-e edmonds-karp vertex limit] [-j threads]\n");
+        exit(1);
+    }
+    for(size_t f = 0; f < FAMILY_COUNT; f++) families[f] = families[f] || !anyFamily;
+    for(size_t e = 0; e < ENGINE_COUNT; e++) engines[e] = engines[e] || !anyEngine;
+
+
+    // Run the suites
+    bool agreed = true;
+    printf("family,vertices,edges,seed,engine,threads,max_flow,build_seconds,solve_seconds,augmenting_paths,pushes,relabels,edge_scans,peak_rss_kb\n");
+    for(size_t f = 0; f < FAMILY_COUNT; f++){
+        if(!families[f]) continue;
+        for(size_t vertices = minVertices; vertices <= maxVertices; vertices *= SIZE_STEP){
+            for(unsigned long seed = 1; seed <= seeds; seed++){
+
+                // Generate the network
+                generator_t gen;
+                gen.family = (family_t)f;
+                gen.seed = seed;
+                gen.maxCapacity = maxCapacity;
+                if(!planNetwork(&gen, vertices, edgesPerVertex * vertices)) exit(1);
+                edgelist_t edges;
+                generateEdgelist(&gen, &edges);
+
+                // Run every engine over it
+                bool first = true;
+                unsigned int expected = 0;
+                for(size_t e = 0; e < ENGINE_COUNT; e++){
+                    if(!engines[e]) continue;
+                    if(e == ENGINE_EDMONDS_KARP && edges.vertices > edmondsKarpLimit) continue;
+
+                    measurement_t m;
+                    runEngine((engine_t)e, &edges, (unsigned int)threads, &m);
+                    printf("%s,%zu,%zu,%lu,%s,%ld,%u,%.6f,%.6f,%llu,%llu,%llu,%llu,%ld\n",
+                        familyNames[f], edges.vertices, edges.count, seed, engineNames[e], (e == ENGINE_PARALLEL) ? threads : 1,
+                        m.maxFlow, m.buildSeconds, m.solveSeconds, m.stats.augmentingPaths, m.stats.pushes, m.stats.relabels,
+                        m.stats.edgeScans, m.peakKilobytes);
+                    fflush(stdout);
+
+                    if(first){
+                        expected = m.maxFlow;
+                        first = false;
+                    } else if(m.maxFlow != expected){
+                        fprintf(stderr, "%s network of %zu vertices, seed %lu: %s found a maximum flow of %u but %u was found before\n",
+                            familyNames[f], edges.vertices, seed, engineNames[e], m.maxFlow, expected);
+                        agreed = false;
+                    }
+                }
+
+                freeEdgelist(&edges);
+            }
+        }
+    }
+
+    if(!agreed) exit(3);
+}
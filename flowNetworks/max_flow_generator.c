@@ -1,7 +1,14 @@
+#include <dirent.h>
+#include <pthread.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "flow_io.h"
+#include "max_flow.h"
 
 /* max_flow_generator.c
  *
@@ -9,149 +16,343 @@
  * An exercise in the Edmonds-Karp Algorithm
  */
 
-// The maximum number of characters we would encounter in reading the input file
-#define DOT_LINE_BUFFER_LENGTH 32
+// The maximum flow engines selectable with -a
+typedef enum engine {
 
-// The longest graph name we would expect plus the maximum flow report length
-#define OUTPUT_NAME_BUFFER_LENGTH 32
+    ENGINE_EDMONDS_KARP,
+    ENGINE_DINIC,
+    ENGINE_FIFO,
+    ENGINE_HIGHEST,
+    ENGINE_PARALLEL
 
+} engine_t;
 
-// An Adjacency Matrix
-typedef struct adjmatrix {
+// Command-line names of the above, in the same order
+const char *engineNames[] = {"edmonds-karp", "dinic", "fifo", "highest", "parallel"};
+#define ENGINE_COUNT (sizeof(engineNames) / sizeof(engineNames[0]))
 
-    size_t vertices;            // The number of vertices in the graph
-    unsigned int *matrix;       // matrix[(u * vertices) + v] is the capacity of edge u->v (0 == no edge)
 
-} adjmatrix_t;
+// The longest line expected in a batch manifest
+#define MANIFEST_LINE_LENGTH 4096
 
 
-// Simple Linked-List queue node
-typedef struct qnode{
+// How each network is to be solved, as set by the options
+typedef struct solveopts {
 
-    unsigned int value;
-    struct qnode *next;    
+    engine_t engine;
+    unsigned int threads;       // Threads for the parallel engine
+    bool check;                 // Check the maximum flow against Edmonds-Karp's
+    bool verbose;               // Report operation counts on stderr
+    char *warmPath;             // A previous flow to warm-start from (NULL for none)
+    char *changesPath;          // Capacity changes to apply to the network first (NULL for none)
+    bool binary;                // Write the flow in binary rather than as DOT
+    unsigned int source;        // The source, numbered from 1 as in the files (0 for the lowest vertex)
+    unsigned int sink;          // The sink, likewise (0 for the highest vertex)
 
-} qnode_t;
+} solveopts_t;
 
-// Associated queue helpers
-void push(qnode_t** queue, unsigned int val){
-    qnode_t* newNode = (qnode_t *)malloc(sizeof(qnode_t));
-    newNode->value = val;
-    newNode->next = *queue;
-    *queue = newNode;
-}
 
-unsigned int pop(qnode_t** queue){
-        unsigned int temp = (*queue)->value;
-        qnode_t *tempNode = *queue;
-        *queue = tempNode->next;
-        free(tempNode);
-        return temp;
-}
 
-bool isEmpty(qnode_t* queue){
-    return (queue == NULL);
-}
+// Computes the maximum flow of the network at inputPath and writes it to outputPath, as the assignment specifies,
+// taking working space from scratch (which may be NULL) and leaving it to the caller to reset
+// Returns 0 on success, or else the status the program should exit with (having reported why on stderr).
+// Its maximum flow is stored in *maxFlowOut.
+int solveNetwork(const char *inputPath, const char *outputPath, solveopts_t *opts, flowscratch_t *scratch, unsigned int *maxFlowOut){
+    engine_t engine = opts->engine;
+
+    // Read the Flow Network's edges
+    edgelist_t edges;
+    char *graphName;
+    if(!readNetwork(inputPath, &edges, &graphName)) return 2;
+    if(opts->changesPath != NULL && !applyCapacityChanges(opts->changesPath, &edges)){
+        freeEdgelist(&edges);
+        free(graphName);
+        return 2;
+    }
+    if(opts->warmPath != NULL && engine == ENGINE_EDMONDS_KARP) engine = ENGINE_DINIC;
+    int status = 0;
+
+    // Relabel the network so that the chosen source and sink are the engines' (see relabelTerminals())
+    unsigned int source = (opts->source == 0) ? 0 : opts->source - 1;
+    unsigned int sink = (opts->sink == 0) ? (unsigned int)edges.vertices - 1 : opts->sink - 1;
+    if(source >= edges.vertices || sink >= edges.vertices || source == sink){
+        fprintf(stderr, "%s: the source and sink must be two different vertices of the network's %zu\n", inputPath, edges.vertices);
+        freeEdgelist(&edges);
+        free(graphName);
+        return 2;
+    }
+    relabelTerminals(&edges, source, sink, false);
+
+    // Space for the flow along each edge
+    unsigned int *edgeFlow = (unsigned int *)scratchAlloc(scratch, edges.count * sizeof(unsigned int));
 
 
+    // Run the selected engine
+    unsigned int maxFlow = 0;
+    flowstats_t stats = {0};
+    if(engine == ENGINE_EDMONDS_KARP){
+        // Edmonds-Karp works on the adjacency matrix
+        adjmatrix_t residual, flow;
+        if(!buildMatrix(&edges, &residual, scratch) || !allocMatrix(&flow, residual.vertices, scratch)){
+            fprintf(stderr, "%s: %zu vertices is too many for an adjacency matrix; try another engine\n", inputPath, edges.vertices);
+            freeMatrix(&residual);
+            status = 4;
+            goto cleanup;
+        }
 
-// Breadth-First Search
-// Parameters: g, a graph to search for paths. We assume that vertex 0 is the source and vertex |V| - 1 is the sink (for simplicity)
-//             p, a "parent list"; an array of size |V| such that p[j] == i <==> (i, j) is and edge in the path
-// Returns true iff a path exists from source to sink.
-// Modifies p to reflect the path.
-// O(|E|) operation
-bool breadthFirstSearch(adjmatrix_t *g, unsigned int* p){
-    // Define a "visited" flag set
-    bool visited[g->vertices];
-    memset(visited, 0, g->vertices * sizeof(bool));
-
-    // Clear parenthood list
-    memset(p, 0, g->vertices * sizeof(unsigned int));
-    
-    // Prepare a queue
-    qnode_t *queue = NULL;
-
-    // Visit and push source node
-    push(&queue, 0);
-    visited[0] = true;
-
-    // Run BFS traversal
-    while(!isEmpty(queue)){
-        unsigned int vertex = pop(&queue);
-        // Mark as visited, enqueue, and reparent to "vertex" all unvisited adjacent vertices to "vertex"
-        for(unsigned int i = 0; i < g->vertices; i++){
-            if(g->matrix[(vertex * g->vertices) + i] != 0 && !visited[i]){
-                visited[i] = true;
-                push(&queue, i);
-                p[i] = vertex;
+        // Run Edmonds-Karp Algorithm
+        maxFlow = edmondsKarp(&residual, &flow, &stats);
+        // "flow" now contains the flow graph.
+        for(size_t i = 0; i < edges.count; i++){
+            edgeFlow[i] = flow.matrix[(edges.edges[i].from * flow.vertices) + edges.edges[i].to];
+        }
+        freeMatrix(&residual);
+        freeMatrix(&flow);
+    } else {
+        // The other engines work on the arc-list residual network
+        flownet_t net;
+        buildFlownet(&edges, &net, scratch);
+
+        // Repair the previous flow, if warm-starting
+        unsigned int repairedFlow = 0;
+        flowstats_t repairStats = {0};
+        if(opts->warmPath != NULL){
+            edgelist_t previous;
+            if(!readFlows(opts->warmPath, &previous)){
+                status = 2;
+            } else {
+                previous.vertices = edges.vertices;
+                relabelTerminals(&previous, source, sink, false);
+                if(!repairFlow(&net, &previous, &repairStats)){
+                    fprintf(stderr, "The flow in %s cannot be repaired into a flow for %s\n", opts->warmPath, inputPath);
+                    status = 5;
+                }
+                freeEdgelist(&previous);
             }
+            repairedFlow = flowValue(&net);
+        }
+        if(status != 0){
+            freeFlownet(&net);
+            goto cleanup;
         }
-    }   
 
-    // Return whether we touched the sink
-    return visited[g->vertices - 1];
-}
+        if(engine == ENGINE_DINIC){
+            maxFlow = dinic(&net, &stats);
+        } else if(engine == ENGINE_FIFO){
+            maxFlow = pushRelabelFIFO(&net, &stats);
+        } else if(engine == ENGINE_HIGHEST){
+            maxFlow = pushRelabelHighest(&net, &stats);
+        } else {
+            maxFlow = pushRelabelParallel(&net, &stats, opts->threads);
+        }
+        maxFlow += repairedFlow;
+        stats.augmentingPaths += repairStats.augmentingPaths;
+        stats.edgeScans += repairStats.edgeScans;
+        for(size_t i = 0; i < edges.count; i++){
+            edgeFlow[i] = net.capacity[net.edgeArc[i]] - net.residual[net.edgeArc[i]];
+        }
+        freeFlownet(&net);
+    }
+
+    if(opts->check && engine != ENGINE_EDMONDS_KARP){
+        // Rerun with Edmonds-Karp
+        adjmatrix_t residual, reference;
+        if(!buildMatrix(&edges, &residual, scratch) || !allocMatrix(&reference, residual.vertices, scratch)){
+            fprintf(stderr, "%s: %zu vertices is too many for an adjacency matrix; cannot check against Edmonds-Karp\n", inputPath, edges.vertices);
+            freeMatrix(&residual);
+            status = 4;
+            goto cleanup;
+        }
+        unsigned int expected = edmondsKarp(&residual, &reference, NULL);
+        freeMatrix(&residual);
+        freeMatrix(&reference);
+        if(expected != maxFlow){
+            fprintf(stderr, "%s: %s found a maximum flow of %u but Edmonds-Karp found %u\n", inputPath, engineNames[engine], maxFlow, expected);
+            status = 3;
+            goto cleanup;
+        }
+    }
 
+    if(opts->verbose){
+        fprintf(stderr, "%s: maximum flow %u, %llu augmenting paths, %llu pushes, %llu relabels, %llu edge scans\n",
+            engineNames[engine], maxFlow, stats.augmentingPaths, stats.pushes, stats.relabels, stats.edgeScans);
+    }
 
 
-// Edmonds-Karp helper function: finds cf(p), the maximum flow through a path (i.e. the capacity of its weakest edge)
-// Parameters: g, p; these are identical to the parameters for BFS above and p should have been produced by an invocation of BFS.
-// O(|p|) operation
-unsigned int pathCapacity(adjmatrix_t *g, unsigned int* p){
-    unsigned int pathCap;
-    memset(&pathCap, 0xFF, sizeof(unsigned int));    // A cheap and perhaps incorrect approximation of infinite capacity
 
-    unsigned int vertex = g->vertices - 1;  // Start at the sink
-    while(vertex != 0){     // Repeat until we hit the source
-        unsigned int edgeCost = g->matrix[(p[vertex] * g->vertices) + vertex];        
-        pathCap = (edgeCost < pathCap) ? edgeCost : pathCap;                    // Store the minimum capacity along the path
-        vertex = p[vertex];
+    // Stream the edges carrying flow to the Output File, under their own vertex numbers
+    relabelTerminals(&edges, source, sink, true);
+    if(!writeFlow(outputPath, &edges, edgeFlow, graphName, maxFlow, opts->binary)){
+        status = 2;
+        goto cleanup;
     }
-    return pathCap;
+    *maxFlowOut = maxFlow;
+
+
+    // Clean up
+cleanup:
+    freeEdgelist(&edges);
+    scratchFree(scratch, edgeFlow);
+    free(graphName);
+    return status;
 }
 
 
 
-// Edmonds-Karp Algorithm
-// Parameters: g, the flow network to be operated upon; this will be overwritten with the residual graph.
-//             f, a space to store the resultant flow graph
-// Returns the maximal flow capacity.
-// O(|V||E|^2) algorithm
-unsigned int edmondsKarp(adjmatrix_t *g, adjmatrix_t *f){
-    // Initialize various things
-    unsigned int maxFlow = 0;
-    unsigned int p[g->vertices];
+// Gomory-Hu mode
+// Builds the Gomory-Hu tree of the network at inputPath on the given number of threads and writes it to outputPath,
+// then answers each "u v" line of the file at queryPath (if not NULL) with "u v cut" on standard output
+// Returns 0 on success, or else the status the program should exit with (having reported why on stderr).
+int cutTreeNetwork(const char *inputPath, const char *outputPath, const char *queryPath, engine_t engine, unsigned int threads){
+    edgelist_t edges;
+    char *graphName;
+    if(!readNetwork(inputPath, &edges, &graphName)) return 2;
+
+    // Only the single-threaded arc-list engines are run per cut (main() admits no other); the threads go to
+    // running cuts side by side
+    flowengine_t run = dinic;
+    if(engine == ENGINE_FIFO) run = pushRelabelFIFO;
+    else if(engine == ENGINE_HIGHEST) run = pushRelabelHighest;
+
+    cuttree_t tree;
+    gomoryHuTree(&edges, &tree, run, threads);
+    int status = writeCuttree(outputPath, &tree, graphName) ? 0 : 2;
+
+    if(status == 0 && queryPath != NULL){
+        FILE *fp = fopen(queryPath, "r");
+        if(fp == NULL){
+            fprintf(stderr, "Couldn't open %s for reading\n", queryPath);
+            status = 2;
+        } else {
+            char line[MANIFEST_LINE_LENGTH];
+            while(fgets(line, MANIFEST_LINE_LENGTH, fp)){
+                unsigned int u, v;
+                if(line[strspn(line, " \t\r\n")] == '\0' || line[0] == '#') continue;
+                if(sscanf(line, "%u %u", &u, &v) != 2 || u == 0 || v == 0 || u > tree.vertices || v > tree.vertices || u == v){
+                    fprintf(stderr, "%s: expected two different vertices of the network's %zu, not: %s", queryPath, tree.vertices, line);
+                    status = 2;
+                    break;
+                }
+                printf("%u %u %u\n", u, v, minimumCut(&tree, u - 1, v - 1));
+            }
+            fclose(fp);
+        }
+    }
 
-    while(breadthFirstSearch(g, p)){
-        // While we can find an augmenting path
+    freeCuttree(&tree);
+    freeEdgelist(&edges);
+    free(graphName);
+    return status;
+}
 
-        // Get the cost of said path
-        unsigned int pathCap = pathCapacity(g, p);
 
-        // Increase our maximum flow by this capacity
-        maxFlow += pathCap;
 
-        // Residualize the graph / augment the flow
-        unsigned int vertex = g->vertices - 1;  // Start at the sink
-        while(vertex != 0){     // Repeat until we hit the source
-            
-            // Recompute the residual
-            g->matrix[(p[vertex] * g->vertices) + vertex] -= pathCap;     // parent->self -= path flow
-            g->matrix[(vertex * g->vertices) + p[vertex]] += pathCap;     // self->parent += path flow
+// Batch mode
+// The networks of a batch and where their flows go
+typedef struct batch {
 
-            // Augment the flow
-            f->matrix[(p[vertex] * f->vertices) + vertex] += pathCap;
+    char **inputs;              // The networks' paths
+    char **outputs;             // The paths their flows are written to
+    size_t count;
+    size_t allocated;
+    solveopts_t *opts;
+
+    size_t next;                // The next network to be claimed by a thread
+    int status;                 // The highest status any network was solved with
+    pthread_mutex_t lock;       // Guards next, status, and standard output
+
+} batch_t;
+
+
+// Adds the network at inputPath to the batch, to be written to the file of the same name in outputDir
+void addBatchNetwork(batch_t *b, const char *inputPath, const char *outputDir){
+    if(b->count == b->allocated){
+        b->allocated = (b->allocated == 0) ? 16 : 2 * b->allocated;
+        b->inputs = (char **)realloc(b->inputs, b->allocated * sizeof(char *));
+        b->outputs = (char **)realloc(b->outputs, b->allocated * sizeof(char *));
+    }
+    const char *base = strrchr(inputPath, '/');
+    base = (base == NULL) ? inputPath : base + 1;
+    size_t length = strlen(outputDir) + strlen(base) + 2;
+    b->inputs[b->count] = strdup(inputPath);
+    b->outputs[b->count] = (char *)malloc(length);
+    snprintf(b->outputs[b->count], length, "%s/%s", outputDir, base);
+    b->count++;
+}
+
+
+// Fills the batch from source: every regular file in it (in name order, skipping hidden files) if it is a
+// directory, or else every path it lists, one per line (blank lines and lines starting with # are skipped)
+// Returns false, having reported why on stderr, if source cannot be read.
+bool readBatch(batch_t *b, const char *source, const char *outputDir){
+    struct stat info;
+    if(stat(source, &info) != 0){
+        fprintf(stderr, "Couldn't open %s for reading\n", source);
+        return false;
+    }
 
-            vertex = p[vertex]; // Move back along the path
+    if(S_ISDIR(info.st_mode)){
+        struct dirent **entries;
+        int n = scandir(source, &entries, NULL, alphasort);
+        if(n < 0){
+            fprintf(stderr, "Couldn't read the directory %s\n", source);
+            return false;
         }
+        for(int i = 0; i < n; i++){
+            size_t length = strlen(source) + strlen(entries[i]->d_name) + 2;
+            char *path = (char *)malloc(length);
+            snprintf(path, length, "%s/%s", source, entries[i]->d_name);
+            if(entries[i]->d_name[0] != '.' && stat(path, &info) == 0 && S_ISREG(info.st_mode)) addBatchNetwork(b, path, outputDir);
+            free(path);
+            free(entries[i]);
+        }
+        free(entries);
+        return true;
+    }
 
+    FILE *fp = fopen(source, "r");
+    if(fp == NULL){
+        fprintf(stderr, "Couldn't open %s for reading\n", source);
+        return false;
+    }
+    char line[MANIFEST_LINE_LENGTH];
+    while(fgets(line, MANIFEST_LINE_LENGTH, fp)){
+        line[strcspn(line, "\r\n")] = '\0';
+        if(line[0] != '\0' && line[0] != '#') addBatchNetwork(b, line, outputDir);
     }
-     
-    return maxFlow;
+    fclose(fp);
+    return true;
 }
 
 
+// A batch thread: solves networks one at a time until none are left, reusing one scratch space throughout,
+// and reports each as it finishes
+void *batchWorker(void *arg){
+    batch_t *b = (batch_t *)arg;
+    flowscratch_t scratch;
+    initScratch(&scratch);
+
+    while(true){
+        pthread_mutex_lock(&(b->lock));
+        size_t i = b->next++;
+        pthread_mutex_unlock(&(b->lock));
+        if(i >= b->count) break;
+
+        unsigned int maxFlow = 0;
+        int status = solveNetwork(b->inputs[i], b->outputs[i], b->opts, &scratch, &maxFlow);
+        resetScratch(&scratch);
+
+        pthread_mutex_lock(&(b->lock));
+        if(status == 0) printf("%s: maximum flow = %u\n", b->inputs[i], maxFlow);
+        else printf("%s: failed\n", b->inputs[i]);
+        fflush(stdout);
+        if(status > b->status) b->status = status;
+        pthread_mutex_unlock(&(b->lock));
+    }
+
+    freeScratch(&scratch);
+    return NULL;
+}
 
 
 
@@ -159,133 +360,153 @@ unsigned int edmondsKarp(adjmatrix_t *g, adjmatrix_t *f){
 // Program takes two arguments (the file paths of input and output) and computes
 // the maximum flow for the given network, storing it as another graph
 // (as specified in the assignment description)
-// Precondition: Input file is well-formed (if in doubt, use only the output of flow_network_generator.c)
+// Options:
+//   -a selects the engine that computes the flow (Edmonds-Karp by default)
+//   -j sets the number of threads for the parallel engine (one per online processor by default)
+//   -c checks the engine's maximum flow against that of Edmonds-Karp, exiting with status 3 if they differ
+//   -v reports the engine's operation counts on stderr
+//   -s and -t choose the source and sink (the lowest and highest vertices by default)
+//   -w warm-starts from a flow this program wrote earlier for the network, repairing it and then augmenting
+//      (with Dinic's Algorithm in place of Edmonds-Karp, which has no arc list to start from)
+//   -d applies a file of capacity changes to the network first, one "from to capacity" per line; a capacity
+//      prefixed with + or - is added to or taken from the edge's current capacity, and new edges are added
+//   -o selects the output format: DOT (the default), or a binary flow for other programs (see flow_io.h)
+//   -b solves a batch: the input is a directory of networks or a file listing their paths, and the output a
+//      directory, in which each network's flow is written under the network's file name. The networks are
+//      solved concurrently on -j threads, each reusing its working space from one network to the next (so
+//      the parallel engine runs on one thread per network), and each is reported on standard output as it
+//      finishes. The program exits with the highest status any network was solved with.
+//   -g writes the network's Gomory-Hu tree in place of a flow, for the minimum cut between every pair of vertices
+//      (with edges taken as undirected), computing its |V| - 1 cuts with Dinic's Algorithm or either push-relabel
+//      engine on -j threads; -q answers a file of "u v" queries from it, printing "u v cut" for each
+// The input may be DOT (as written by flow_network_generator.c) or a text or binary edge list; see flow_io.h
 int main(int argc, char **argv){
 
-    // Verify argument
-    if (argc != 3){
-        fprintf(stderr, "Usage: flow_network_generator <input path> <output path>\n");
-        exit(1);
-    }
-
-    // Allocate new adjacency matrix describing our Flow Network
-    adjmatrix_t flownet;
-    flownet.vertices = 5; // Given by spec, we know there are at least 5 vertices
-    flownet.matrix = (unsigned int *)calloc(flownet.vertices * flownet.vertices, sizeof(unsigned int));
-    
-    
-    // Parse input into adjacency matrix
-    FILE *fp = fopen(argv[1], "r");
-    if (fp == NULL) {
-        fprintf(stderr, "Couldn't open %s for reading\n", argv[1]); 
-        exit(2);
-    }
-
-    char buffer[DOT_LINE_BUFFER_LENGTH];
-    char outputName[OUTPUT_NAME_BUFFER_LENGTH];
-
-    // Discard the first four lines
-    fgets(buffer, DOT_LINE_BUFFER_LENGTH - 1, fp);
-    fgets(buffer, DOT_LINE_BUFFER_LENGTH - 1, fp);
-    fgets(buffer, DOT_LINE_BUFFER_LENGTH - 1, fp);
-    fgets(buffer, DOT_LINE_BUFFER_LENGTH - 1, fp);
-    fgets(buffer, DOT_LINE_BUFFER_LENGTH - 1, fp);
-
-    // Read in edges, line by line
-    while(strlen(buffer) > 1){
-        unsigned int edgeSource, edgeDest, edgeCap;
-        sscanf(buffer, "%u -> %u [label = \" %u \"];\n", &edgeSource, &edgeDest, &edgeCap);
-
-        // Check to see if we need to resize the adjacency matrix
-        if(edgeSource > flownet.vertices || edgeDest > flownet.vertices){
-            // realloc() won't cut it for this problem...
-            // Allocate a region of the appropriate maximum size
-            unsigned int newVertices = (edgeSource > edgeDest) ? edgeSource : ((edgeDest > flownet.vertices) ? edgeDest : edgeSource);
-            unsigned int *newMatrix = (unsigned int *)calloc(newVertices * newVertices, sizeof(unsigned int));
-            for(int i = 0; i < flownet.vertices; i++){
-                memcpy(&(newMatrix[i * newVertices]), &(flownet.matrix[i * flownet.vertices]), flownet.vertices * sizeof(unsigned int));
+    // Parse options
+    solveopts_t opts = {ENGINE_EDMONDS_KARP, 1, false, false, NULL, NULL, false, 0, 0};
+    long threads = sysconf(_SC_NPROCESSORS_ONLN);
+    bool batchMode = false;
+    bool treeMode = false;
+    bool engineGiven = false;
+    char *queryPath = NULL;
+    int opt;
+    while((opt = getopt(argc, argv, "a:bcd:gj:o:q:s:t:vw:")) != -1){
+        if(opt == 'a'){
+            size_t e = 0;
+            while(e < ENGINE_COUNT && strcmp(optarg, engineNames[e]) != 0) e++;
+            if(e == ENGINE_COUNT){
+                fprintf(stderr, "Unknown engine %s (expected edmonds-karp, dinic, fifo, highest or parallel)\n", optarg);
+                exit(1);
+            }
+            opts.engine = (engine_t)e;
+            engineGiven = true;
+        } else if(opt == 'b'){
+            batchMode = true;
+        } else if(opt == 'c'){
+            opts.check = true;
+        } else if(opt == 'g'){
+            treeMode = true;
+        } else if(opt == 'q'){
+            queryPath = optarg;
+        } else if(opt == 's' || opt == 't'){
+            long vertex = atol(optarg);
+            if(vertex < 1){
+                fprintf(stderr, "Vertices are numbered from 1\n");
+                exit(1);
+            }
+            if(opt == 's') opts.source = (unsigned int)vertex;
+            else opts.sink = (unsigned int)vertex;
+        } else if(opt == 'j'){
+            threads = atol(optarg);
+            if(threads < 1){
+                fprintf(stderr, "Thread count must be at least 1\n");
+                exit(1);
             }
-            flownet.vertices = newVertices;
-            unsigned int *temp = flownet.matrix;
-            flownet.matrix = newMatrix;
-            free(temp);
+        } else if(opt == 'v'){
+            opts.verbose = true;
+        } else if(opt == 'w'){
+            opts.warmPath = optarg;
+        } else if(opt == 'd'){
+            opts.changesPath = optarg;
+        } else if(opt == 'o'){
+            if(strcmp(optarg, "dot") != 0 && strcmp(optarg, "binary") != 0){
+                fprintf(stderr, "Unknown output format %s (expected dot or binary)\n", optarg);
+                exit(1);
+            }
+            opts.binary = (strcmp(optarg, "binary") == 0);
+        } else {
+            argc = 0;   // Fall through to the usage message
+            break;
         }
+    }
 
-        // Add the edge to the Matrix
-        flownet.matrix[((edgeSource - 1) * flownet.vertices) + (edgeDest - 1)] = edgeCap;
-
-        // Fetch the next line
-        fgets(buffer, DOT_LINE_BUFFER_LENGTH - 1, fp);
+    // Verify argument
+    if (argc - optind != 2){
+        fprintf(stderr, "Usage: max_flow_generator [-a edmonds-karp|dinic|fifo|highest|parallel] [-j threads] [-c] [-v] [-o dot|binary] [-s source] [-t sink] [-w previous flow] [-d capacity changes] <input path> <output path>\n");
+        fprintf(stderr, "       max_flow_generator -b [-a edmonds-karp|dinic|fifo|highest|parallel] [-j threads] [-c] [-v] [-o dot|binary] [-s source] [-t sink] <input directory or manifest> <output directory>\n");
+        fprintf(stderr, "       max_flow_generator -g [-a dinic|fifo|highest] [-j threads] [-q queries] <input path> <output path>\n");
+        exit(1);
     }
+    char *inputPath = argv[optind];
+    char *outputPath = argv[optind + 1];
 
-    // Read the graph name
-    fgets(buffer, DOT_LINE_BUFFER_LENGTH - 1, fp);
-    sscanf(buffer, "label = \"%s", outputName);
-    // For some reason scanf catches the closing quotation mark, thus:
-    outputName[strlen(outputName) - 1] = '\0';
 
-    // Close the Input File
-    fclose(fp);
- 
-
-
-    // Duplicate the graph
-    adjmatrix_t residual;
-    residual.vertices = flownet.vertices;
-    residual.matrix = (unsigned int *)calloc(residual.vertices * residual.vertices, sizeof(unsigned int));
-    memcpy(residual.matrix, flownet.matrix, residual.vertices * residual.vertices * sizeof(unsigned int));
-
-    // Allocate space for an output flow
-    adjmatrix_t flow;
-    flow.vertices = flownet.vertices;
-    flow.matrix = (unsigned int *)calloc(flow.vertices * flow.vertices, sizeof(unsigned int));
-
-
-    // Run Edmonds-Karp Algorithm
-    unsigned int maxFlow = edmondsKarp(&residual, &flow);
-    // "flow" now contains the flow graph.
- 
-    
-
-    // Convert Flow Network edges to .dot list format string
-    // Same technique as in flow_network_generator.c
-    char outBuffer[flow.vertices * flow.vertices * DOT_LINE_BUFFER_LENGTH];
-    char *bufHead = outBuffer;
-    for(int i = 0; i < flow.vertices; i++){
-        for(int j = 0; j < flow.vertices; j++){
-            // For every edge (i, j)
-            unsigned int edgeCapacity = flow.matrix[(i * flow.vertices) + j];
-            unsigned int maxCapacity = flownet.matrix[(i * flownet.vertices) + j];
-            if (maxCapacity != 0 && edgeCapacity != 0){
-                // An edge exists; append it to our output string
-                bufHead += snprintf(bufHead, DOT_LINE_BUFFER_LENGTH, "%d -> %d [label = \" %d/%d \"];\n", i+1, j+1, edgeCapacity, maxCapacity);
-            }
+    if(queryPath != NULL && !treeMode){
+        fprintf(stderr, "-q queries a Gomory-Hu tree, and needs -g\n");
+        exit(1);
+    }
+    if(treeMode){
+        if(batchMode || opts.warmPath != NULL || opts.changesPath != NULL || opts.source != 0 || opts.sink != 0){
+            fprintf(stderr, "-g builds one network's Gomory-Hu tree, and takes none of -b, -w, -d, -s or -t\n");
+            exit(1);
         }
+        if(opts.check || opts.verbose || opts.binary){
+            fprintf(stderr, "-g writes a Gomory-Hu tree in DOT, and takes none of -c, -v or -o binary\n");
+            exit(1);
+        }
+        if(engineGiven && opts.engine != ENGINE_DINIC && opts.engine != ENGINE_FIFO && opts.engine != ENGINE_HIGHEST){
+            fprintf(stderr, "-g runs its cuts on dinic, fifo or highest, not %s\n", engineNames[opts.engine]);
+            exit(1);
+        }
+        if(!engineGiven) opts.engine = ENGINE_DINIC;
+        int status = cutTreeNetwork(inputPath, outputPath, queryPath, opts.engine, (unsigned int)threads);
+        if(status != 0) exit(status);
+        return 0;
     }
 
-    // Append the total flow size to the label
-    snprintf(outputName + strlen(outputName), OUTPUT_NAME_BUFFER_LENGTH - strlen(outputName), ": maximum flow = %u ", maxFlow); 
-    
-
-    // Open the Output File for writing
-    fp = fopen(argv[2], "w");
-    if (fp == NULL) {
-        fprintf(stderr, "Couldn't open %s for writing\n", argv[2]); 
-        exit(2);
+    if(!batchMode){
+        opts.threads = (unsigned int)threads;
+        unsigned int maxFlow;
+        int status = solveNetwork(inputPath, outputPath, &opts, NULL, &maxFlow);
+        if(status != 0) exit(status);
+        return 0;
     }
 
 
-    // Write .dot skeleton fleshed with our graph to the file
-    fprintf(fp, "digraph g{\n\nrankdir = LR\n\n%s\nlabel = \"%s\"\n}\n", outBuffer, outputName);
-
-
-    // Close the Output File
-    fclose(fp);
-
-
-    // Clean up
-    free(flownet.matrix);
-    free(residual.matrix);
-    free(flow.matrix);
-
+    // Solve a batch
+    if(opts.warmPath != NULL || opts.changesPath != NULL){
+        fprintf(stderr, "-w and -d apply to a single network, not a batch\n");
+        exit(1);
+    }
+    batch_t b;
+    memset(&b, 0, sizeof(batch_t));
+    b.opts = &opts;
+    if(!readBatch(&b, inputPath, outputPath)) exit(2);
+    pthread_mutex_init(&(b.lock), NULL);
+
+    if((size_t)threads > b.count) threads = (b.count == 0) ? 1 : (long)b.count;
+    pthread_t *workers = (pthread_t *)malloc(threads * sizeof(pthread_t));
+    for(long i = 1; i < threads; i++) pthread_create(&(workers[i]), NULL, batchWorker, &b);
+    batchWorker(&b);
+    for(long i = 1; i < threads; i++) pthread_join(workers[i], NULL);
+    free(workers);
+    pthread_mutex_destroy(&(b.lock));
+
+    for(size_t i = 0; i < b.count; i++){
+        free(b.inputs[i]);
+        free(b.outputs[i]);
+    }
+    free(b.inputs);
+    free(b.outputs);
+    if(b.status != 0) exit(b.status);
 }
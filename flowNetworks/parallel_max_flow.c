@@ -0,0 +1,343 @@
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "max_flow.h"
+
+/* parallel_max_flow.c
+ *
+ * A multithreaded Push-Relabel engine for max_flow_generator
+ *
+ * The threads work in synchronous rounds. In each round the active vertices are dealt out to the threads
+ * through a shared cursor and discharged concurrently, reading the heights their neighbours had at the start
+ * of the round. A vertex only pushes into vertices that are inactive this round (whose heights cannot
+ * change under it), which keeps every height valid without locking; the lowest active vertex can always
+ * push or relabel, so each round makes progress. Pushed excess is accumulated atomically and claimed
+ * vertices are appended to the next round's frontier through an atomic index, so neither the excess
+ * updates nor the work queues take locks.
+ */
+
+
+// Frontier vertices handed to a thread at a time
+#define DISCHARGE_CHUNK 16
+
+
+// Shared solver state
+typedef struct pprstate {
+
+    flownet_t *net;
+    size_t V;
+    unsigned int threads;
+
+    atomic_uint *height;            // height[v] is the distance label of v at the start of the round
+    unsigned int *newHeight;        // newHeight[v] is the label v ended this round's discharge with
+    long long *excess;              // excess[v], owned by whichever thread is discharging v
+    atomic_llong *added;            // Excess pushed into v this round, folded into excess[v] after it
+    unsigned int *current;          // current[v] is the current-arc pointer of v
+    bool *active;                   // Whether v is in this round's frontier (read-only during the round)
+    atomic_bool *queued;            // Whether v has been claimed for the next round's frontier
+
+    unsigned int *frontier;         // This round's active vertices
+    size_t frontierSize;
+    atomic_size_t cursor;           // Index of the next frontier vertex to hand out
+    unsigned int *nextFrontier;     // Next round's active vertices
+    atomic_size_t nextSize;
+
+    unsigned int *bfs, *bfsNext;    // Level queues for global relabelling
+    size_t bfsSize;
+    atomic_size_t bfsNextSize;
+
+    atomic_size_t work;             // Relabel work since the last global relabel
+    bool relabelDue;
+    bool done;
+    pthread_barrier_t barrier;
+
+} pprstate_t;
+
+
+// Per-thread state
+typedef struct pprthread {
+
+    pprstate_t *s;
+    unsigned int id;
+    flowstats_t counts;
+    pthread_t thread;
+
+} pprthread_t;
+
+
+
+// Appends v to the next frontier unless it has already been claimed
+void claimVertex(pprstate_t *s, unsigned int v){
+    if(!atomic_exchange(&(s->queued[v]), true)){
+        s->nextFrontier[atomic_fetch_add(&(s->nextSize), 1)] = v;
+    }
+}
+
+
+
+// Parallel global relabel; every thread must call this together.
+// Recomputes exact distance labels by level-synchronous reverse BFS, first from the sink and then (offset by |V|)
+// from the source, with each vertex claimed by compare-and-swap on its height.
+void parallelGlobalRelabel(pprstate_t *s, pprthread_t *t){
+    flownet_t *net = s->net;
+    size_t V = s->V;
+    unsigned int unlabelled = 2 * V - 1;
+
+    for(size_t v = t->id; v < V; v += s->threads){
+        s->height[v] = unlabelled;
+        s->current[v] = net->first[v];
+    }
+    pthread_barrier_wait(&(s->barrier));
+
+    if(t->id == 0){
+        s->height[0] = V;
+        s->height[V - 1] = 0;
+    }
+
+    // Two passes: the first grows from the sink, the second from the source
+    unsigned int roots[2] = {V - 1, 0};
+    for(int pass = 0; pass < 2; pass++){
+        if(t->id == 0){
+            s->bfs[0] = roots[pass];
+            s->bfsSize = 1;
+            s->bfsNextSize = 0;
+        }
+        pthread_barrier_wait(&(s->barrier));
+
+        while(s->bfsSize > 0){
+            for(size_t k = t->id; k < s->bfsSize; k += s->threads){
+                unsigned int u = s->bfs[k];
+                unsigned int label = s->height[u] + 1;
+                for(unsigned int a = net->first[u]; a < net->first[u + 1]; a++){
+                    unsigned int w = net->head[a];
+                    unsigned int expected = unlabelled;
+                    if(net->residual[net->mate[a]] != 0 && atomic_compare_exchange_strong(&(s->height[w]), &expected, label)){
+                        s->bfsNext[atomic_fetch_add(&(s->bfsNextSize), 1)] = w;
+                    }
+                }
+                t->counts.edgeScans += net->first[u + 1] - net->first[u];
+            }
+            pthread_barrier_wait(&(s->barrier));
+
+            if(t->id == 0){
+                unsigned int *temp = s->bfs;
+                s->bfs = s->bfsNext;
+                s->bfsNext = temp;
+                s->bfsSize = s->bfsNextSize;
+                s->bfsNextSize = 0;
+            }
+            pthread_barrier_wait(&(s->barrier));
+        }
+
+        // Every thread must have seen the empty level before the next pass refills it
+        pthread_barrier_wait(&(s->barrier));
+    }
+}
+
+
+
+// Discharges u for one round, using the round's starting heights of its neighbours
+void parallelDischarge(pprstate_t *s, pprthread_t *t, unsigned int u){
+    flownet_t *net = s->net;
+    unsigned int unlabelled = 2 * s->V - 1;
+    unsigned int end = net->first[u + 1];
+    long long e = s->excess[u];
+    unsigned int h = s->height[u];
+    size_t work = 0;
+
+    while(e > 0){
+        if(s->current[u] == end){
+            // Relabel
+            unsigned int newHeight = unlabelled;
+            for(unsigned int a = net->first[u]; a < end; a++){
+                if(net->residual[a] != 0 && s->height[net->head[a]] + 1 < newHeight){
+                    newHeight = s->height[net->head[a]] + 1;
+                    s->current[u] = a;
+                }
+            }
+            t->counts.relabels++;
+            t->counts.edgeScans += end - net->first[u];
+            work += 12 + (end - net->first[u]);
+            h = newHeight;
+            if(h >= unlabelled) break;
+            continue;
+        }
+
+        unsigned int a = s->current[u];
+        unsigned int v = net->head[a];
+        t->counts.edgeScans++;
+        if(net->residual[a] != 0 && h == s->height[v] + 1){
+            // Active neighbours may be relabelling; leave this arc for a later round
+            if(s->active[v]) break;
+
+            unsigned int delta = (e < net->residual[a]) ? (unsigned int)e : net->residual[a];
+            net->residual[a] -= delta;
+            net->residual[net->mate[a]] += delta;
+            e -= delta;
+            atomic_fetch_add(&(s->added[v]), delta);
+            t->counts.pushes++;
+            if(v != 0 && v != s->V - 1) claimVertex(s, v);
+        } else {
+            s->current[u]++;
+        }
+    }
+
+    s->excess[u] = e;
+    s->newHeight[u] = h;
+    if(e > 0 && h < unlabelled) claimVertex(s, u);
+    if(work > 0) atomic_fetch_add(&(s->work), work);
+}
+
+
+
+// Thread body: alternates discharge rounds and commits until no vertex is active
+void *parallelWorker(void *arg){
+    pprthread_t *t = (pprthread_t *)arg;
+    pprstate_t *s = t->s;
+
+    parallelGlobalRelabel(s, t);
+
+    while(true){
+        // Discharge this round's frontier
+        size_t i;
+        while((i = atomic_fetch_add(&(s->cursor), DISCHARGE_CHUNK)) < s->frontierSize){
+            size_t end = (i + DISCHARGE_CHUNK < s->frontierSize) ? i + DISCHARGE_CHUNK : s->frontierSize;
+            for(; i < end; i++) parallelDischarge(s, t, s->frontier[i]);
+        }
+        pthread_barrier_wait(&(s->barrier));
+
+        // Commit the new heights and retire this round's frontier...
+        for(size_t k = t->id; k < s->frontierSize; k += s->threads){
+            unsigned int u = s->frontier[k];
+            s->height[u] = s->newHeight[u];
+            s->active[u] = false;
+        }
+        pthread_barrier_wait(&(s->barrier));
+
+        // ...then activate the next, folding in the excess pushed to it
+        size_t nextSize = s->nextSize;
+        for(size_t k = t->id; k < nextSize; k += s->threads){
+            unsigned int v = s->nextFrontier[k];
+            s->excess[v] += atomic_exchange(&(s->added[v]), 0);
+            s->queued[v] = false;
+            s->active[v] = true;
+        }
+        pthread_barrier_wait(&(s->barrier));
+
+        if(t->id == 0){
+            unsigned int *temp = s->frontier;
+            s->frontier = s->nextFrontier;
+            s->nextFrontier = temp;
+            s->frontierSize = nextSize;
+            s->nextSize = 0;
+            s->cursor = 0;
+            s->done = (nextSize == 0);
+            s->relabelDue = (s->work > 6 * s->V + s->net->arcs / 2);
+            if(s->relabelDue) s->work = 0;
+        }
+        pthread_barrier_wait(&(s->barrier));
+
+        if(s->done) break;
+        if(s->relabelDue) parallelGlobalRelabel(s, t);
+    }
+
+    return NULL;
+}
+
+
+
+// Parallel Push-Relabel Algorithm
+// Parameters: net, stats; as for dinic()
+//             threads, the number of threads to run on
+// Returns the maximal flow capacity.
+// The labels are refreshed by a parallel global relabel whenever the relabelling work since the last one passes
+// the usual threshold; there is no gap heuristic, as it would need the height counts kept in step across threads.
+unsigned int pushRelabelParallel(flownet_t *net, flowstats_t *stats, unsigned int threads){
+    size_t V = net->vertices;
+    if(threads < 1) threads = 1;
+
+    pprstate_t s;
+    s.net = net;
+    s.V = V;
+    s.threads = threads;
+    s.height = (atomic_uint *)scratchAlloc(net->scratch, V * sizeof(atomic_uint));
+    s.newHeight = (unsigned int *)scratchAlloc(net->scratch, V * sizeof(unsigned int));
+    s.excess = (long long *)scratchCalloc(net->scratch, V, sizeof(long long));
+    s.added = (atomic_llong *)scratchAlloc(net->scratch, V * sizeof(atomic_llong));
+    s.current = (unsigned int *)scratchAlloc(net->scratch, V * sizeof(unsigned int));
+    s.active = (bool *)scratchCalloc(net->scratch, V, sizeof(bool));
+    s.queued = (atomic_bool *)scratchAlloc(net->scratch, V * sizeof(atomic_bool));
+    s.frontier = (unsigned int *)scratchAlloc(net->scratch, V * sizeof(unsigned int));
+    s.nextFrontier = (unsigned int *)scratchAlloc(net->scratch, V * sizeof(unsigned int));
+    s.bfs = (unsigned int *)scratchAlloc(net->scratch, V * sizeof(unsigned int));
+    s.bfsNext = (unsigned int *)scratchAlloc(net->scratch, V * sizeof(unsigned int));
+    for(size_t v = 0; v < V; v++){
+        atomic_init(&(s.added[v]), 0);
+        atomic_init(&(s.queued[v]), false);
+    }
+    atomic_init(&(s.cursor), 0);
+    atomic_init(&(s.nextSize), 0);
+    atomic_init(&(s.bfsNextSize), 0);
+    atomic_init(&(s.work), 0);
+    s.frontierSize = 0;
+    s.relabelDue = false;
+    s.done = false;
+
+    // Saturate every arc leaving the source; the vertices it reaches form the first frontier
+    for(unsigned int a = net->first[0]; a < net->first[1]; a++){
+        unsigned int v = net->head[a];
+        unsigned int delta = net->residual[a];
+        net->residual[a] = 0;
+        net->residual[net->mate[a]] += delta;
+        if(v == V - 1){
+            s.added[v] += delta;
+        } else if(delta != 0){
+            s.excess[v] += delta;
+            if(!s.active[v] && v != 0){
+                s.active[v] = true;
+                s.frontier[s.frontierSize++] = v;
+            }
+        }
+    }
+
+    // Run the workers, the calling thread among them
+    pthread_barrier_init(&(s.barrier), NULL, threads);
+    pprthread_t *workers = (pprthread_t *)scratchCalloc(net->scratch, threads, sizeof(pprthread_t));
+    for(unsigned int i = 0; i < threads; i++){
+        workers[i].s = &s;
+        workers[i].id = i;
+        if(i > 0) pthread_create(&(workers[i].thread), NULL, parallelWorker, &(workers[i]));
+    }
+    parallelWorker(&(workers[0]));
+
+    flowstats_t counts = {0};
+    for(unsigned int i = 0; i < threads; i++){
+        if(i > 0) pthread_join(workers[i].thread, NULL);
+        counts.pushes += workers[i].counts.pushes;
+        counts.relabels += workers[i].counts.relabels;
+        counts.edgeScans += workers[i].counts.edgeScans;
+    }
+    if(stats != NULL) *stats = counts;
+
+    // Everything pushed into the sink is still waiting in its accumulator
+    unsigned int maxFlow = (unsigned int)s.added[V - 1];
+
+    pthread_barrier_destroy(&(s.barrier));
+    scratchFree(net->scratch, workers);
+    scratchFree(net->scratch, s.height);
+    scratchFree(net->scratch, s.newHeight);
+    scratchFree(net->scratch, s.excess);
+    scratchFree(net->scratch, s.added);
+    scratchFree(net->scratch, s.current);
+    scratchFree(net->scratch, s.active);
+    scratchFree(net->scratch, s.queued);
+    scratchFree(net->scratch, s.frontier);
+    scratchFree(net->scratch, s.nextFrontier);
+    scratchFree(net->scratch, s.bfs);
+    scratchFree(net->scratch, s.bfsNext);
+    return maxFlow;
+}
@@ -0,0 +1,430 @@
+#include <ctype.h>
+#include <errno.h>
+#include <limits.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "stringMatchers.h"
+
+/* stringMatchBench.c
+ *
+ * Runs the three string matchers over seeded generated texts, with pattern
+ * families chosen to find their worst cases, checks that they find the same
+ * shifts, and reports their throughput as CSV.
+ */
+
+
+// Suite controls
+// Length of every generated text, and texts (seeds) per alphabet
+#define DEFAULT_TEXT_LENGTH (1 << 20)
+#define DEFAULT_SEEDS 1
+
+// Each matcher is rerun over a text until this much time has passed, and timed over all its runs
+#define MIN_BENCHMARK_SECONDS 0.1
+
+// The periodic text is runs of this many 'a's, each ended by a 'b'
+#define PERIODIC_RUN 4096
+
+// Length of the long patterns (within stringMatchStats' 1024 character lines, so -w's pattern file can be read)
+#define LONG_PATTERN_LENGTH 1000
+
+// Longest path written by -w
+#define PATH_LENGTH 4096
+
+
+// The texts, in the order they are run and reported
+typedef enum alphabet {
+
+    ALPHABET_BINARY,        // Uniformly random 'a's and 'b's
+    ALPHABET_DNA,           // Uniformly random 'A's, 'C's, 'G's and 'T's
+    ALPHABET_ENGLISH,       // Words of random letters, at English letter frequencies, in sentences and lines
+    ALPHABET_BYTES,         // Uniformly random bytes, '\0' and those past 127 included
+    ALPHABET_PERIODIC       // PERIODIC_RUN 'a's and a 'b', over and over
+
+} alphabet_t;
+
+const char *alphabetNames[] = {"binary", "dna", "english", "bytes", "periodic"};
+#define ALPHABET_COUNT (sizeof(alphabetNames) / sizeof(alphabetNames[0]))
+
+
+// The patterns searched for in each text, in the order they are run and reported
+typedef enum family {
+
+    FAMILY_SAMPLED,         // Substrings of the text itself, so found at least once
+    FAMILY_PERIODIC,        // x^(m - 1) y: Naive matching's worst case wherever the text has long runs of x
+    FAMILY_LONG             // LONG_PATTERN_LENGTH random symbols, whose DFA is costly to build
+
+} family_t;
+
+const char *familyNames[] = {"sampled", "periodic", "long"};
+#define FAMILY_COUNT (sizeof(familyNames) / sizeof(familyNames[0]))
+
+// Lengths of the patterns of each family (0 for none)
+#define LENGTHS_PER_FAMILY 2
+const size_t patternLengths[FAMILY_COUNT][LENGTHS_PER_FAMILY] = {{4, 32}, {16, 256}, {LONG_PATTERN_LENGTH, 0}};
+
+
+// The algorithms, in the order they are run and reported
+typedef void (*matcher_t)(char *, size_t, char *, size_t, FILE *);
+const char *algorithmNames[] = {"naive", "dfa", "kmp"};
+const matcher_t matchers[] = {naiveMatch, DFAMatch, KMPMatch};
+#define ALGORITHM_COUNT (sizeof(algorithmNames) / sizeof(algorithmNames[0]))
+
+
+// English letters, each as many times per 1000 letters as it appears in English text
+const char *englishLetters = "etaoinshrdlcumwfgypbvkjxqz";
+const unsigned int englishFrequencies[] = {127, 91, 82, 75, 70, 67, 63, 61, 60, 43, 40, 28, 28, 24, 24, 22, 20, 20, 19, 15, 10, 8, 2, 2, 1, 1};
+
+
+
+// Seconds on the monotonic clock
+double now(void){
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + (t.tv_nsec / 1e9);
+}
+
+
+// SplitMix64, so that the same seed makes the same texts and patterns everywhere
+uint64_t nextRandom(uint64_t *state){
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// A random number in 0 .. n - 1 (for n < 2^32)
+uint32_t randomBelow(uint64_t *state, uint32_t n){
+    return (uint32_t)(((nextRandom(state) >> 32) * (uint64_t)n) >> 32);
+}
+
+
+char englishLetter(uint64_t *state){
+    unsigned int r = randomBelow(state, 1000);
+    size_t l = 0;
+    while(l + 1 < strlen(englishLetters) && r >= englishFrequencies[l]){
+        r -= englishFrequencies[l];
+        l++;
+    }
+    return englishLetters[l];
+}
+
+
+// Generates a text of the given alphabet and length (free it)
+char *generateText(alphabet_t alphabet, size_t length, uint64_t *state){
+    char *text = (char *)malloc(length + 1);
+    size_t i = 0;
+    if(alphabet == ALPHABET_ENGLISH){
+        // Words of 1 to 9 letters; sentences of 4 to 19 words; lines of 1 to 5 sentences
+        unsigned int words = 0, sentences = 0;
+        unsigned int sentenceWords = 4 + randomBelow(state, 16), lineSentences = 1 + randomBelow(state, 5);
+        while(i < length){
+            unsigned int letters = 1 + randomBelow(state, 9);
+            for(unsigned int l = 0; l < letters && i < length; l++) text[i++] = englishLetter(state);
+            const char *separator = " ";
+            if(++words == sentenceWords){
+                words = 0;
+                sentenceWords = 4 + randomBelow(state, 16);
+                separator = ". ";
+                if(++sentences == lineSentences){
+                    sentences = 0;
+                    lineSentences = 1 + randomBelow(state, 5);
+                    separator = ".\n";
+                }
+            }
+            for(const char *s = separator; *s != '\0' && i < length; s++) text[i++] = *s;
+        }
+    } else {
+        for(; i < length; i++){
+            if(alphabet == ALPHABET_BINARY) text[i] = "ab"[randomBelow(state, 2)];
+            else if(alphabet == ALPHABET_DNA) text[i] = "ACGT"[randomBelow(state, 4)];
+            else if(alphabet == ALPHABET_BYTES) text[i] = (char)randomBelow(state, 256);
+            else text[i] = ((i % (PERIODIC_RUN + 1)) == PERIODIC_RUN) ? 'b' : 'a';
+        }
+    }
+    text[length] = '\0';
+    return text;
+}
+
+
+// Whether a byte can appear in a pattern: anything but '\0', and (so that -w can write every pattern on a line of
+// a pattern file) '\n'
+bool patternByte(char c){
+    return c != '\0' && c != '\n';
+}
+
+
+// A random symbol of the alphabet, fit for a pattern
+char randomSymbol(alphabet_t alphabet, uint64_t *state){
+    if(alphabet == ALPHABET_BINARY || alphabet == ALPHABET_PERIODIC) return "ab"[randomBelow(state, 2)];
+    if(alphabet == ALPHABET_DNA) return "ACGT"[randomBelow(state, 4)];
+    if(alphabet == ALPHABET_ENGLISH) return englishLetter(state);
+    char c;
+    do c = (char)randomBelow(state, 256); while(!patternByte(c));
+    return c;
+}
+
+
+// Generates a pattern of the given family and length for the text (free it). A pattern file's lines of hyphens
+// start with a '-', so no pattern does.
+char *generatePattern(family_t family, size_t length, char *text, size_t textLength, alphabet_t alphabet, uint64_t *state){
+    char *pattern = (char *)malloc(length + 1);
+    pattern[length] = '\0';
+
+    if(family == FAMILY_SAMPLED && length <= textLength){
+        // Take the first fit substring from a random offset on
+        size_t start = randomBelow(state, (uint32_t)(textLength - length + 1));
+        for(size_t tries = 0; tries <= textLength - length; tries++){
+            size_t offset = (start + tries) % (textLength - length + 1);
+            bool fit = (text[offset] != '-');
+            for(size_t j = 0; j < length && fit; j++) fit = patternByte(text[offset + j]);
+            if(fit){
+                memcpy(pattern, text + offset, length);
+                return pattern;
+            }
+        }
+    }
+
+    if(family == FAMILY_PERIODIC){
+        char x = randomSymbol(alphabet, state), y;
+        if(alphabet == ALPHABET_PERIODIC) x = 'a';     // The runs of the periodic text are of 'a'
+        do y = randomSymbol(alphabet, state); while(y == x);
+        memset(pattern, x, length - 1);
+        pattern[length - 1] = y;
+    } else {
+        for(size_t j = 0; j < length; j++) pattern[j] = randomSymbol(alphabet, state);
+    }
+    if(pattern[0] == '-') pattern[0] = 'x';
+    return pattern;
+}
+
+
+
+// The result of one matcher's runs over one text
+typedef struct measurement {
+
+    char *output;               // What the matcher wrote: [shifts] <preprocessing cost, shifts, compares>
+    size_t outputSize;
+    size_t matches;
+    unsigned long long preprocessingCost;
+    unsigned long long shifts;
+    unsigned long long compares;
+    double seconds;             // Per timed run
+
+} measurement_t;
+
+
+// Runs the matcher over the text once to capture its output, then reruns it with its output discarded until
+// minSeconds have passed (not at all if that is 0, when the capturing run is timed instead), and parses the output
+void runMatcher(matcher_t matcher, char *text, size_t textLength, char *pattern, double minSeconds, FILE *sink, measurement_t *m){
+    memset(m, 0, sizeof(measurement_t));
+    size_t patternLength = strlen(pattern);
+    double start = now();
+    FILE *output = open_memstream(&(m->output), &(m->outputSize));
+    matcher(text, textLength, pattern, patternLength, output);
+    fclose(output);
+    m->seconds = now() - start;
+
+    if(minSeconds > 0){
+        unsigned long runs = 0;
+        double elapsed;
+        start = now();
+        do {
+            matcher(text, textLength, pattern, patternLength, sink);
+            runs++;
+        } while((elapsed = now() - start) < minSeconds);
+        m->seconds = elapsed / runs;
+    }
+
+    char *close = strchr(m->output, ']');
+    if(close[-1] != '['){
+        m->matches = 1;
+        for(char *c = m->output; c < close; c++) if(*c == ',') m->matches++;
+    }
+    sscanf(close, "] <%llu, %llu, %llu>", &(m->preprocessingCost), &(m->shifts), &(m->compares));
+}
+
+
+// Whether two matchers found the same shifts
+bool sameShifts(measurement_t *a, measurement_t *b){
+    size_t length = (size_t)(strchr(a->output, ']') - a->output);
+    return strncmp(a->output, b->output, length + 1) == 0;
+}
+
+
+// Writes a generated text to <directory>/<alphabet>-<seed>.txt, and its patterns as a segment of the pattern file
+void writeCorpus(char *directory, alphabet_t alphabet, unsigned long seed, char *text, size_t textLength, char **patterns, size_t count, FILE *pf){
+    char path[PATH_LENGTH];
+    snprintf(path, PATH_LENGTH, "%s/%s-%lu.txt", directory, alphabetNames[alphabet], seed);
+    FILE *fp = fopen(path, "w");
+    if(fp == NULL || fwrite(text, 1, textLength, fp) != textLength){
+        fprintf(stderr, "Failed to write %s\n", path);
+        exit(2);
+    }
+    fclose(fp);
+
+    fprintf(pf, "%s\n", path);
+    for(size_t p = 0; p < count; p++) fprintf(pf, "%s\n", patterns[p]);
+    fprintf(pf, "----------\n");
+}
+
+
+
+// Reads a count given to an option, which must be a decimal number and nothing else
+bool parseCount(const char *text, unsigned long long *count){
+    char *end;
+    errno = 0;
+    *count = strtoull(text, &end, 10);
+    return isdigit((unsigned char)text[0]) && *end == '\0' && errno == 0;
+}
+
+
+
+// Main Function
+// Program takes no arguments. For every alphabet and seed, it generates a text and the patterns of every family
+// for it, and runs every matcher over each, writing one CSV row per run to standard output. The matchers must
+// find the same shifts; the program exits with status 3 if they ever do not (having reported which on stderr),
+// so it also serves as a regression test.
+// Options:
+//   -a limits the run to one alphabet (repeatable)
+//   -c runs each matcher once, only to check that they agree (seconds is then that run's, output collection included)
+//   -f limits the run to one pattern family (repeatable)
+//   -n sets the length of the texts
+//   -r sets the number of seeds per alphabet (seeds run from 1)
+//   -w writes the texts, and a pattern file of their patterns, to the given directory
+int main(int argc, char **argv){
+
+    // Parse options
+    bool alphabets[ALPHABET_COUNT] = {false};
+    bool families[FAMILY_COUNT] = {false};
+    bool anyAlphabet = false, anyFamily = false;
+    size_t textLength = DEFAULT_TEXT_LENGTH;
+    unsigned long seeds = DEFAULT_SEEDS;
+    double minSeconds = MIN_BENCHMARK_SECONDS;
+    char *directory = NULL;
+    int opt;
+    while((opt = getopt(argc, argv, "a:cf:n:r:w:")) != -1){
+        if(opt == 'a'){
+            size_t a = 0;
+            while(a < ALPHABET_COUNT && strcmp(optarg, alphabetNames[a]) != 0) a++;
+            if(a == ALPHABET_COUNT){
+                fprintf(stderr, "Unknown alphabet %s (expected binary, dna, english, bytes or periodic)\n", optarg);
+                exit(1);
+            }
+            alphabets[a] = anyAlphabet = true;
+        } else if(opt == 'c'){
+            minSeconds = 0;
+        } else if(opt == 'f'){
+            size_t f = 0;
+            while(f < FAMILY_COUNT && strcmp(optarg, familyNames[f]) != 0) f++;
+            if(f == FAMILY_COUNT){
+                fprintf(stderr, "Unknown pattern family %s (expected sampled, periodic or long)\n", optarg);
+                exit(1);
+            }
+            families[f] = anyFamily = true;
+        } else if(opt == 'n' || opt == 'r'){
+            unsigned long long count;
+            if(!parseCount(optarg, &count)){
+                argc = 0;   // Fall through to the usage message
+                break;
+            }
+            if(opt == 'n') textLength = (count < ((size_t)1 << 32)) ? (size_t)count : 0;
+            else seeds = (count <= ULONG_MAX) ? (unsigned long)count : 0;
+        } else if(opt == 'w'){
+            directory = optarg;
+        } else {
+            argc = 0;   // Fall through to the usage message
+            break;
+        }
+    }
+
+    // Verify arguments
+    if(argc - optind != 0 || textLength < 1 || seeds < 1){
+        fprintf(stderr, "Usage: stringMatchBench [-a alphabet]... [-c] [-f family]... [-n text length] [-r seeds] [-w directory]\n");
+        exit(1);
+    }
+    for(size_t a = 0; a < ALPHABET_COUNT; a++) alphabets[a] = alphabets[a] || !anyAlphabet;
+    for(size_t f = 0; f < FAMILY_COUNT; f++) families[f] = families[f] || !anyFamily;
+
+    FILE *pf = NULL;
+    char pfPath[PATH_LENGTH];
+    if(directory != NULL){
+        snprintf(pfPath, PATH_LENGTH, "%s/patterns.txt", directory);
+        pf = fopen(pfPath, "w");
+        if(pf == NULL){
+            fprintf(stderr, "Failed to open %s\n", pfPath);
+            exit(2);
+        }
+        fprintf(pf, "----------\n");
+    }
+
+
+    // The timed runs write their shifts here, so that collecting them costs no more than formatting them
+    FILE *sink = fopen("/dev/null", "w");
+    if(sink == NULL){
+        fprintf(stderr, "Failed to open /dev/null\n");
+        exit(2);
+    }
+
+
+    // Run the suites
+    bool agreed = true;
+    printf("alphabet,text_bytes,seed,family,pattern_length,algorithm,matches,preprocessing_cost,shifts,compares,seconds,gb_per_s\n");
+    for(size_t a = 0; a < ALPHABET_COUNT; a++){
+        if(!alphabets[a]) continue;
+        for(unsigned long seed = 1; seed <= seeds; seed++){
+
+            // Generate the text, and its patterns, each from its own stream (so that -a and -f leave the rest as they were)
+            uint64_t base = ((seed * ALPHABET_COUNT) + a) * (1 + (FAMILY_COUNT * LENGTHS_PER_FAMILY));
+            uint64_t state = base;
+            char *text = generateText((alphabet_t)a, textLength, &state);
+            char *patterns[FAMILY_COUNT * LENGTHS_PER_FAMILY];
+            family_t patternFamilies[FAMILY_COUNT * LENGTHS_PER_FAMILY];
+            size_t count = 0;
+            for(size_t f = 0; f < FAMILY_COUNT; f++){
+                if(!families[f]) continue;
+                for(size_t l = 0; l < LENGTHS_PER_FAMILY && patternLengths[f][l] > 0; l++){
+                    state = base + 1 + (f * LENGTHS_PER_FAMILY) + l;
+                    patternFamilies[count] = (family_t)f;
+                    patterns[count++] = generatePattern((family_t)f, patternLengths[f][l], text, textLength, (alphabet_t)a, &state);
+                }
+            }
+            if(pf != NULL) writeCorpus(directory, (alphabet_t)a, seed, text, textLength, patterns, count, pf);
+
+            // Run every matcher over it for each pattern
+            for(size_t p = 0; p < count; p++){
+                size_t patternLength = strlen(patterns[p]);
+                fprintf(stderr, "%s text, seed %lu: %s pattern of %zu\n", alphabetNames[a], seed, familyNames[patternFamilies[p]], patternLength);
+                measurement_t m[ALGORITHM_COUNT];
+                for(size_t g = 0; g < ALGORITHM_COUNT; g++){
+                    runMatcher(matchers[g], text, textLength, patterns[p], minSeconds, sink, &(m[g]));
+                    printf("%s,%zu,%lu,%s,%zu,%s,%zu,%llu,%llu,%llu,%.6f,%.3f\n",
+                        alphabetNames[a], textLength, seed, familyNames[patternFamilies[p]], patternLength, algorithmNames[g],
+                        m[g].matches, m[g].preprocessingCost, m[g].shifts, m[g].compares, m[g].seconds, (textLength / m[g].seconds) / 1e9);
+                    fflush(stdout);
+
+                    if(g > 0 && !sameShifts(&(m[0]), &(m[g]))){
+                        fprintf(stderr, "%s text, seed %lu, %s pattern of %zu: %s found different shifts than %s\n",
+                            alphabetNames[a], seed, familyNames[patternFamilies[p]], patternLength, algorithmNames[g], algorithmNames[0]);
+                        agreed = false;
+                    }
+                }
+                for(size_t g = 0; g < ALGORITHM_COUNT; g++) free(m[g].output);
+                free(patterns[p]);
+            }
+            free(text);
+        }
+    }
+
+    fclose(sink);
+    if(pf != NULL){
+        fclose(pf);
+        fprintf(stderr, "Texts and pattern file stored in %s\n", directory);
+    }
+    if(!agreed) exit(3);
+}
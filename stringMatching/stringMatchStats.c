@@ -1,4 +1,7 @@
+#define _GNU_SOURCE     // For readahead()
+#include <ctype.h>
 #include <fcntl.h>
+#include <pthread.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -7,6 +10,8 @@
 #include <sys/mman.h>
 #include <unistd.h>
 
+#include "stringMatchers.h"
+
 /* stringMatchStats.c
  *
  * A demonstration of the relative efficiencies of 
@@ -15,152 +20,530 @@
  * Written 8 December 2019 by Thomas Pinkava
  */
 
-#define PFBUF_SIZE 1024 // Maximum length of line in the pattern file
-
-// Naive String Matching
-// All three matching techniques take the text and pattern as input strings and write their resultant statistics
-// directly to the output filestream
-// O(mn) algorithm with zero preprocessing cost
-void naiveMatch(char *text, size_t textLength, char *pattern, size_t patternLength, FILE *output){
-    // Zero statistics and print initial
-    unsigned int totalCharCompares = 0;
-    bool foundAtLeastOne = false;
-    fprintf(output, "[");
-
-    // For every character in the text
-    for(size_t i = 0; i < textLength; i++){
-        // Check to see if this character is the start character of the pattern
-        bool match = true;
-        for(size_t j = 0; j < patternLength; j++){
-            totalCharCompares++;
-            if(text[i + j] != pattern[j]){
-                match = false;
-                break;
-            }
+#define PFBUF_SIZE 1024 // Maximum length of line in the pattern file (so the DFA states of a pattern fit an unsigned short)
+
+
+// A text of the pattern file and the patterns to search it for
+typedef struct scanjob {
+    char *path;
+    char **patterns;
+    size_t count;
+    size_t allocated;
+
+    // Filled in when scanned by the pipeline
+    char *segment;          // The text's segment of the statistics table
+    size_t segmentSize;
+    char *log;              // Its progress messages
+    size_t logSize;
+    bool failed;            // Whether the text couldn't be opened
+    bool done;
+} scanjob_t;
+
+
+// Reads the pattern file: a line of hyphens, then each text's path followed by its patterns and another line of hyphens
+// Returns the number of texts, whose jobs are stored in *jobs (free them with freeJobs())
+size_t loadPatternFile(FILE *pf, scanjob_t **jobs){
+    size_t count = 0, allocated = 0;
+    *jobs = NULL;
+    char pfbuf[PFBUF_SIZE];
+    // Discard the leading hyphen line
+    fgets(pfbuf, PFBUF_SIZE, pf);
+    while(fgets(pfbuf, PFBUF_SIZE, pf)){
+        if(count == allocated){
+            allocated = allocated ? 2 * allocated : 16;
+            *jobs = (scanjob_t *)realloc(*jobs, allocated * sizeof(scanjob_t));
         }
-        if(match){
-            foundAtLeastOne = true;
-            fprintf(output, "%zu, ", i);
+        scanjob_t *job = &((*jobs)[count++]);
+        memset(job, 0, sizeof(scanjob_t));
+        pfbuf[strcspn(pfbuf, "\n")] = '\0';
+        job->path = strdup(pfbuf);
+
+        // Every line up to the closing hyphen line is a pattern, but for any blank ones
+        while(fgets(pfbuf, PFBUF_SIZE, pf)){
+            if(pfbuf[0] == '-') break;
+            pfbuf[strcspn(pfbuf, "\n")] = '\0';
+            if(pfbuf[0] == '\0') continue;
+            if(job->count == job->allocated){
+                job->allocated = job->allocated ? 2 * job->allocated : 16;
+                job->patterns = (char **)realloc(job->patterns, job->allocated * sizeof(char *));
+            }
+            job->patterns[job->count++] = strdup(pfbuf);
         }
     }
+    return count;
+}
+
 
-    fprintf(output, "%s] <0, %zu, %u>", foundAtLeastOne?"\b\b":"", textLength-patternLength, totalCharCompares);
+void freeJobs(scanjob_t *jobs, size_t count){
+    for(size_t i = 0; i < count; i++){
+        for(size_t p = 0; p < jobs[i].count; p++) free(jobs[i].patterns[p]);
+        free(jobs[i].patterns);
+        free(jobs[i].path);
+        free(jobs[i].segment);
+        free(jobs[i].log);
+    }
+    free(jobs);
+}
+
+// Pattern-Specialized Scanners
+// stringMatchStats -g writes the C source of a scanner for the texts and patterns of a pattern file.
+// Every pattern is compiled into its own matcher: its DFA (whose transitions fold in the KMP failure function)
+// becomes straight-line code, one label per state with a switch over the symbols that lead anywhere but state 0,
+// and state 0 hands the search for the pattern's first character to memchr(). The same DFA is also written out
+// as a constant table, which the scanner runs through a generic table-driven loop; the scanner times both, and
+// KMP computing its prefix function at run time, and checks that all three find the same shifts.
+
+// Fixed parts of the generated scanner, before and after the per-pattern matchers
+static const char *scannerPrologue[] = {
+    "#include <fcntl.h>",
+    "#include <stdbool.h>",
+    "#include <stdio.h>",
+    "#include <stdlib.h>",
+    "#include <string.h>",
+    "#include <sys/mman.h>",
+    "#include <sys/stat.h>",
+    "#include <time.h>",
+    "#include <unistd.h>",
+    "",
+    "#define MIN_BENCHMARK_SECONDS 0.05    // Each matcher is rerun over a text until this much time has passed",
+    "",
+    "typedef struct shiftlist {",
+    "    size_t *shifts;",
+    "    size_t count;",
+    "    size_t allocated;",
+    "} shiftlist_t;",
+    "",
+    "static void addShift(shiftlist_t *list, size_t shift){",
+    "    if(list->count == list->allocated){",
+    "        list->allocated = list->allocated ? 2 * list->allocated : 64;",
+    "        list->shifts = (size_t *)realloc(list->shifts, list->allocated * sizeof(size_t));",
+    "    }",
+    "    list->shifts[list->count++] = shift;",
+    "}",
+    "",
+    "typedef struct matcher {",
+    "    const char *pattern;",
+    "    size_t length;",
+    "    void (*compiled)(const unsigned char *, size_t, shiftlist_t *);",
+    "    const unsigned short (*transitions)[256];",
+    "} matcher_t;",
+    "",
+    "typedef struct scantext {",
+    "    const char *path;",
+    "    size_t first;       // Index of the text's first pattern in matchers[]",
+    "    size_t count;",
+    "} scantext_t;",
+    NULL
+};
+
+static const char *scannerEpilogue[] = {
+    "// The interpreted paths: the pattern's DFA run from its table, and KMP",
+    "static void tableMatch(const matcher_t *m, const unsigned char *text, size_t length, shiftlist_t *found){",
+    "    unsigned int state = 0;",
+    "    for(size_t i = 0; i < length; i++){",
+    "        state = m->transitions[state][text[i]];",
+    "        if(state == m->length) addShift(found, i + 1 - m->length);",
+    "    }",
+    "}",
+    "",
+    "static void KMPMatch(const matcher_t *m, const unsigned char *text, size_t length, shiftlist_t *found){",
+    "    const unsigned char *pattern = (const unsigned char *)m->pattern;",
+    "    size_t *prefixFunction = (size_t *)malloc(m->length * sizeof(size_t));",
+    "    size_t k = 0;",
+    "    prefixFunction[0] = 0;",
+    "    for(size_t q = 1; q < m->length; q++){",
+    "        while(k > 0 && pattern[k] != pattern[q]) k = prefixFunction[k - 1];",
+    "        if(pattern[k] == pattern[q]) k++;",
+    "        prefixFunction[q] = k;",
+    "    }",
+    "    size_t q = 0;",
+    "    for(size_t i = 0; i < length; i++){",
+    "        while(q > 0 && pattern[q] != text[i]) q = prefixFunction[q - 1];",
+    "        if(pattern[q] == text[i]) q++;",
+    "        if(q == m->length){",
+    "            addShift(found, i + 1 - m->length);",
+    "            q = prefixFunction[q - 1];",
+    "        }",
+    "    }",
+    "    free(prefixFunction);",
+    "}",
+    "",
+    "static double now(void){",
+    "    struct timespec t;",
+    "    clock_gettime(CLOCK_MONOTONIC, &t);",
+    "    return t.tv_sec + t.tv_nsec * 1e-9;",
+    "}",
+    "",
+    "// Runs one of the matchers (0 compiled, 1 table, 2 KMP) over the text until MIN_BENCHMARK_SECONDS have passed,",
+    "// leaving its shifts in found",
+    "// Returns its throughput in GB/s",
+    "static double benchmark(const matcher_t *m, int which, const unsigned char *text, size_t length, shiftlist_t *found){",
+    "    unsigned long runs = 0;",
+    "    double start = now(), elapsed;",
+    "    do {",
+    "        found->count = 0;",
+    "        if(which == 0) m->compiled(text, length, found);",
+    "        else if(which == 1) tableMatch(m, text, length, found);",
+    "        else KMPMatch(m, text, length, found);",
+    "        runs++;",
+    "    } while((elapsed = now() - start) < MIN_BENCHMARK_SECONDS);",
+    "    return ((double)length * runs) / elapsed / 1e9;",
+    "}",
+    "",
+    "static bool sameShifts(shiftlist_t *a, shiftlist_t *b){",
+    "    return a->count == b->count && (a->count == 0 || memcmp(a->shifts, b->shifts, a->count * sizeof(size_t)) == 0);",
+    "}",
+    "",
+    "// Takes the output path to which the shifts and throughputs (GB/s of the compiled, table and KMP matchers)",
+    "// of every pattern will be written",
+    "// Exits with status 3 if the matchers disagree on any pattern's shifts",
+    "int main(int argc, char **argv){",
+    "    if(argc != 2){",
+    "        fprintf(stderr, \"Usage: %s <output path>\\n\", argv[0]);",
+    "        exit(1);",
+    "    }",
+    "    FILE *output = fopen(argv[1], \"w\");",
+    "    if(output == NULL){",
+    "        fprintf(stderr, \"Failed to open %s\\n\", argv[1]);",
+    "        exit(2);",
+    "    }",
+    "",
+    "    int status = 0;",
+    "    shiftlist_t found[3] = {{NULL, 0, 0}, {NULL, 0, 0}, {NULL, 0, 0}};",
+    "    for(size_t t = 0; t < sizeof(texts) / sizeof(texts[0]); t++){",
+    "        int fd = open(texts[t].path, O_RDONLY);",
+    "        if(fd == -1){",
+    "            fprintf(stderr, \"Failed to open %s\\n\", texts[t].path);",
+    "            exit(2);",
+    "        }",
+    "        fprintf(stderr, \"File %s open for scanning.\\n\", texts[t].path);",
+    "        fprintf(output, \"%s\\n\", texts[t].path);",
+    "        struct stat fileStats;",
+    "        fstat(fd, &fileStats);",
+    "        size_t length = (size_t)fileStats.st_size;",
+    "        const unsigned char *text = NULL;",
+    "        if(length > 0){",
+    "            text = (const unsigned char *)mmap(0, length, PROT_READ, MAP_SHARED, fd, 0);",
+    "            if(text == MAP_FAILED){",
+    "                fprintf(stderr, \"Failed to map %s\\n\", texts[t].path);",
+    "                exit(2);",
+    "            }",
+    "        }",
+    "",
+    "        for(size_t i = texts[t].first; i < texts[t].first + texts[t].count; i++){",
+    "            const matcher_t *m = &(matchers[i]);",
+    "            fprintf(stderr, \"\\tScanning for '%s'\\n\", m->pattern);",
+    "            double throughput[3];",
+    "            for(int which = 0; which < 3; which++) throughput[which] = benchmark(m, which, text, length, &(found[which]));",
+    "            if(!sameShifts(&(found[0]), &(found[1])) || !sameShifts(&(found[0]), &(found[2]))){",
+    "                fprintf(stderr, \"Matchers disagree on the shifts of '%s' in %s\\n\", m->pattern, texts[t].path);",
+    "                status = 3;",
+    "            }",
+    "",
+    "            fprintf(output, \"%s, [\", m->pattern);",
+    "            for(size_t s = 0; s < found[0].count; s++) fprintf(output, \"%s%zu\", s ? \", \" : \"\", found[0].shifts[s]);",
+    "            fprintf(output, \"] <%.3f, %.3f, %.3f>\\n\", throughput[0], throughput[1], throughput[2]);",
+    "        }",
+    "",
+    "        if(length > 0) munmap((void *)text, length);",
+    "        close(fd);",
+    "        fprintf(output, \"\\n\\n\");",
+    "    }",
+    "",
+    "    for(int which = 0; which < 3; which++) free(found[which].shifts);",
+    "    fclose(output);",
+    "    return status;",
+    "}",
+    NULL
+};
+
+
+void writeLines(FILE *out, const char **lines){
+    for(size_t i = 0; lines[i] != NULL; i++) fprintf(out, "%s\n", lines[i]);
 }
 
 
+// Writes a byte as a C character constant (or, when it has no plain one, as its value)
+void writeCharConstant(FILE *out, unsigned char c){
+    if(isprint(c) && c != '\'' && c != '\\') fprintf(out, "'%c'", c);
+    else fprintf(out, "%u", c);
+}
 
 
-// Helper for DFA Matching; computes [Pk suffixof PqC]? 
-bool isSuffix(char *p, unsigned int k, unsigned int q, char c){
-    q = q + 1;
-    if(k > q) return false;
-    if(k == 0) return true;
-    char *b = p + (q - k);
-    for(unsigned int i = 0; i < k - 1; i++){
-        if(p[i] != b[i]) return false;
+// Writes a string as a C string literal, escaping anything that isn't plainly printable
+void writeStringLiteral(FILE *out, const char *str){
+    fputc('"', out);
+    for(const unsigned char *c = (const unsigned char *)str; *c != '\0'; c++){
+        if(isprint(*c) && *c != '"' && *c != '\\' && *c != '?') fputc(*c, out);
+        else fprintf(out, "\\%03o", *c);
     }
-    if(p[k - 1] != c){
-        return false;
-    } else {
-        return true;
+    fputc('"', out);
+}
+
+
+// Writes the transition table and compiled matcher of one pattern, numbered index
+void writeMatcher(FILE *out, char *pattern, size_t patternLength, size_t index){
+    unsigned int (*transitions)[256] = (unsigned int (*)[256])malloc((patternLength + 1) * sizeof(*transitions));
+    transitionFunction(pattern, patternLength, transitions);
+
+    fprintf(out, "// ");
+    writeStringLiteral(out, pattern);
+    fprintf(out, "\nstatic const unsigned short transitions%zu[%zu][256] = {\n", index, patternLength + 1);
+    for(size_t q = 0; q <= patternLength; q++){
+        fprintf(out, "    [%zu] = {", q);
+        bool first = true;
+        for(unsigned int c = 1; c < 256; c++){
+            if(transitions[q][c] == 0) continue;
+            fprintf(out, "%s[", first ? "" : ", ");
+            writeCharConstant(out, (unsigned char)c);
+            fprintf(out, "] = %u", transitions[q][c]);
+            first = false;
+        }
+        fprintf(out, "},\n");
+    }
+    fprintf(out, "};\n\n");
+
+    fprintf(out, "static void compiledMatch%zu(const unsigned char *text, size_t length, shiftlist_t *found){\n", index);
+    fprintf(out, "    const unsigned char *p = text, *end = text + length, *next;\n");
+    fprintf(out, "state0:\n");
+    fprintf(out, "    if(p == end || (next = (const unsigned char *)memchr(p, ");
+    writeCharConstant(out, (unsigned char)pattern[0]);
+    fprintf(out, ", (size_t)(end - p))) == NULL) return;\n");
+    fprintf(out, "    p = next + 1;\n");
+    fprintf(out, "    goto state1;\n");
+    for(size_t q = 1; q <= patternLength; q++){
+        fprintf(out, "state%zu:\n", q);
+        if(q == patternLength) fprintf(out, "    addShift(found, (size_t)(p - text) - %zu);\n", patternLength);
+        fprintf(out, "    if(p == end) return;\n");
+        fprintf(out, "    switch(*p++){\n");
+        // Group the symbols by the state they lead to
+        for(unsigned int target = 1; target <= patternLength; target++){
+            bool any = false;
+            for(unsigned int c = 1; c < 256; c++){
+                if(transitions[q][c] != target) continue;
+                fprintf(out, "%s", any ? " " : "        ");
+                fprintf(out, "case ");
+                writeCharConstant(out, (unsigned char)c);
+                fprintf(out, ":");
+                any = true;
+            }
+            if(any) fprintf(out, " goto state%u;\n", target);
+        }
+        fprintf(out, "    }\n");
+        fprintf(out, "    goto state0;\n");
     }
+    fprintf(out, "}\n\n\n");
+
+    free(transitions);
 }
 
 
+// Writes the source of the scanner for the texts and patterns of the pattern file (named patternPath) to out;
+// there must be at least one pattern
+void generateScanner(scanjob_t *jobs, size_t count, char *patternPath, FILE *out){
+    fprintf(out, "/* Pattern-specialized scanner for the patterns of ");
+    writeStringLiteral(out, patternPath);
+    fprintf(out, ",\n * generated by stringMatchStats -g; regenerate it rather than editing it.\n */\n\n");
+    writeLines(out, scannerPrologue);
+    fprintf(out, "\n\n");
 
-// Deterministic Finite Automaton String Matching
-// Generates a DFA that recognizes the given pattern and uses the given text as its input
-// All three matching techniques take the text and pattern as input strings and write their resultant statistics
-// directly to the output filestream
-// O(n) algorithm with O(m^3 |symbol set|) preprocessing cost
-void DFAMatch(char *text, size_t textLength, char *pattern, size_t patternLength, FILE *output){
-    // Zero statistics and print initial
-    unsigned int totalCharCompares = 0;
-    unsigned int totalShifts = 0;
-    unsigned int preprocessingCost = 0;
-    bool foundAtLeastOne = false;
-    fprintf(output, "[");
-
-    // Compute the Automaton's transition table
-    unsigned int transitionFunction[patternLength + 1][255];    // For simplicity, the symbol set is all 2^8 ASCII chars minus '\0'
-    for(unsigned int q = 0; q <= (unsigned int) patternLength; q++){
-        // For every state
-        for(unsigned char c = 255; c > 0; c--){
-            // For every symbol in symbolset 
-            unsigned int k = ((patternLength + 1) < (q + 2)) ? patternLength + 1: q + 2;
-            while(!isSuffix(pattern, k, q, c)) k--;
-            transitionFunction[q][c - 1] = k; 
-
-            preprocessingCost += k;
+    size_t patterns = 0;
+    for(size_t t = 0; t < count; t++){
+        for(size_t p = 0; p < jobs[t].count; p++){
+            writeMatcher(out, jobs[t].patterns[p], strlen(jobs[t].patterns[p]), patterns++);
         }
     }
-
-    // Run the Automaton on the text
-    unsigned int state = 0;
-    for(size_t i = 0; i < textLength; i++){
-        totalCharCompares++;
-        state = transitionFunction[state][(text[i] - 1)];
-        if(state == 1) totalShifts++;   // We've bounced back to trying to start a pattern-match here; so add to the total shifts
-        if(state == patternLength){
-            fprintf(output,"%zu, ", i - (patternLength - 1));
-            foundAtLeastOne = true;
+    fprintf(out, "static const matcher_t matchers[] = {\n");
+    patterns = 0;
+    for(size_t t = 0; t < count; t++){
+        for(size_t p = 0; p < jobs[t].count; p++){
+            fprintf(out, "    {");
+            writeStringLiteral(out, jobs[t].patterns[p]);
+            fprintf(out, ", %zu, compiledMatch%zu, transitions%zu},\n", strlen(jobs[t].patterns[p]), patterns, patterns);
+            patterns++;
         }
     }
-    
+    fprintf(out, "};\n\n");
+
+    fprintf(out, "static const scantext_t texts[] = {\n");
+    patterns = 0;
+    for(size_t t = 0; t < count; t++){
+        fprintf(out, "    {");
+        writeStringLiteral(out, jobs[t].path);
+        fprintf(out, ", %zu, %zu},\n", patterns, jobs[t].count);
+        patterns += jobs[t].count;
+    }
+    fprintf(out, "};\n\n\n");
+    writeLines(out, scannerEpilogue);
+}
+
 
-    fprintf(output, "%s] <%u, %u, %u>", foundAtLeastOne?"\b\b":"", preprocessingCost, totalShifts, totalCharCompares);
+
+
+// Scans a text for each of its patterns with all three techniques, writing the text's segment of the statistics
+// table to output and its progress to log (outputPath only names the table in the progress messages)
+// Returns false if the text couldn't be opened
+bool scanText(scanjob_t *job, FILE *output, FILE *log, char *outputPath){
+    // Map the text file into memory
+    // 1) Open the file for reading:
+    int fd = open(job->path, O_RDONLY);
+    if(fd == -1){
+        fprintf(log, "Failed to open %s\n", job->path);
+        return false;
+    }
+    fprintf(log, "File %s open for scanning.\n", job->path);
+    fprintf(output, "%s\n", job->path);
+
+    // 2) determine file's size:
+    struct stat fileStats;
+    fstat(fd, &fileStats);
+
+    // 3) map file into memory as page(s), and have the kernel start reading it all in
+    char *text = mmap(0, fileStats.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    if(text != MAP_FAILED) madvise(text, fileStats.st_size, MADV_WILLNEED);
+    // Now we may access text as an array; a requirement given by the naive algorithm.
+    // It's Liebig's Law of the Minimum but for computing...
+
+    for(size_t p = 0; p < job->count; p++){
+        // For every pattern
+        char *pattern = job->patterns[p];
+        size_t patternLength = strlen(pattern);
+        fprintf(output, "%s, ", pattern);
+        fprintf(log, "\tScanning for '%s'\n", pattern);
+
+        // Run Naive Matching
+        naiveMatch(text, (size_t)fileStats.st_size, pattern, patternLength, output);
+        fprintf(output, ", ");
+
+        // Run DFA Matching
+        DFAMatch(text, (size_t)fileStats.st_size, pattern, patternLength, output);
+        fprintf(output, ", ");
+
+        // Run KMP Matching
+        KMPMatch(text, (size_t)fileStats.st_size, pattern, patternLength, output);
+        fprintf(output, "\n");
+    }
+
+    fprintf(log, "Statistics stored in %s\n", outputPath);
+
+    // Unmap and close the text file
+    munmap(text, fileStats.st_size);
+    close(fd);
+
+    // Output some newlines in preparation for next file
+    fprintf(output, "\n\n");
+    return true;
 }
 
 
 
 
-// Knuth-Morris-Pratt String Matching
-// Isomorphic to DFAMatch but with a streamlined transition function allowing lower preprocessing cost
-// All three matching techniques take the text and pattern as input strings and write their resultant statistics
-// directly to the output filestream
-// O(n) algorithm with O(m) preprocessing cost
-void KMPMatch(char *text, size_t textLength, char *pattern, size_t patternLength, FILE *output){
-    // Zero statistics and print initial
-    unsigned int totalCharCompares = 0;
-    unsigned int totalShifts = 0;
-    unsigned int preprocessingCost = 0;
+// Pipelined Scanning
+// With -j, several texts are scanned at once, each by the next free thread in pattern-file order, while a prefetcher
+// thread has the kernel read the texts that will be claimed next into the page cache (with readahead()), so that
+// scanning them doesn't stall on page faults. Each text's segment and progress messages are gathered in memory and
+// written out in pattern-file order, as soon as every text before it has been, so the output is that of a
+// sequential scan.
+typedef struct pipeline {
+
+    scanjob_t *jobs;
+    size_t count;
+    FILE *output;
+    char *outputPath;
+    size_t depth;               // How many texts beyond those being scanned are prefetched
+
+    size_t nextJob;             // The next text to be claimed
+    size_t nextPrefetch;        // The next text to be prefetched
+    size_t nextWrite;           // The next text whose segment is to be written
+    pthread_mutex_t lock;       // Guards all of the above, the jobs' done flags and the output
+    pthread_cond_t claimed;     // Signalled whenever a text is claimed
+
+} pipeline_t;
 
-    // Compute the prefix function
-    unsigned int prefixFunction[patternLength];
-    prefixFunction[0] = 0;
-    unsigned int k = 0;
-    for(unsigned int q = 1; q < (unsigned int)patternLength; q++){
-        while(k > 0 && pattern[k] != pattern[q]){
-            k = prefixFunction[k - 1];
-            preprocessingCost++;
+
+void *prefetchWorker(void *arg){
+    pipeline_t *pl = (pipeline_t *)arg;
+
+    pthread_mutex_lock(&(pl->lock));
+    while(pl->nextPrefetch < pl->count){
+        if(pl->nextPrefetch >= pl->nextJob + pl->depth){
+            pthread_cond_wait(&(pl->claimed), &(pl->lock));
+            continue;
         }
-        if(pattern[k] == pattern[q]) k++;
-        prefixFunction[q] = k;
-        preprocessingCost++;
-    }
- 
-    // Run the KMP Matcher
-    bool foundAtLeastOne = false;
-    fprintf(output, "[");
-
-    unsigned int q = 0;
-    // For every character in the text
-    for(unsigned int i = 0; i < (unsigned int) textLength; i++){
-        while(q > 0 && pattern[q] != text[i]){
-            q = prefixFunction[q - 1];      
-            totalCharCompares++;
+        size_t t = pl->nextPrefetch++;
+        pthread_mutex_unlock(&(pl->lock));
+
+        // A text that can't be opened is left for its scanner to report
+        int fd = open(pl->jobs[t].path, O_RDONLY);
+        if(fd != -1){
+            struct stat fileStats;
+            if(fstat(fd, &fileStats) == 0) readahead(fd, 0, (size_t)fileStats.st_size);
+            close(fd);
         }
-        totalCharCompares++;
-        if(pattern[q] == text[i]) q++;
-        if(q == 1) totalShifts++;   // We've bounced back to attempting to match at this position; add one to the total shifts    
-        if(q == patternLength){
-            fprintf(output,"%u, ", (i + 1) - (unsigned int)patternLength);
-            foundAtLeastOne = true;
-            q = prefixFunction[q - 1];    
+
+        pthread_mutex_lock(&(pl->lock));
+    }
+    pthread_mutex_unlock(&(pl->lock));
+    return NULL;
+}
+
+
+void *scanWorker(void *arg){
+    pipeline_t *pl = (pipeline_t *)arg;
+
+    pthread_mutex_lock(&(pl->lock));
+    while(pl->nextJob < pl->count){
+        scanjob_t *job = &(pl->jobs[pl->nextJob++]);
+        pthread_cond_broadcast(&(pl->claimed));
+        pthread_mutex_unlock(&(pl->lock));
+
+        FILE *segment = open_memstream(&(job->segment), &(job->segmentSize));
+        FILE *log = open_memstream(&(job->log), &(job->logSize));
+        job->failed = !scanText(job, segment, log, pl->outputPath);
+        fclose(segment);
+        fclose(log);
+
+        // Write out every finished text whose turn it is; a text that couldn't be opened ends the run there,
+        // as it would a sequential one
+        pthread_mutex_lock(&(pl->lock));
+        job->done = true;
+        while(pl->nextWrite < pl->count && pl->jobs[pl->nextWrite].done){
+            scanjob_t *next = &(pl->jobs[pl->nextWrite++]);
+            fwrite(next->log, 1, next->logSize, stderr);
+            if(next->failed) exit(2);
+            fwrite(next->segment, 1, next->segmentSize, pl->output);
         }
     }
+    pthread_mutex_unlock(&(pl->lock));
+    return NULL;
+}
 
-    fprintf(output, "%s] <%u, %u, %u>", foundAtLeastOne?"\b\b":"", preprocessingCost, totalShifts, totalCharCompares);
+
+// Scans the texts on the given number of threads (plus the prefetcher)
+void scanPipelined(scanjob_t *jobs, size_t count, FILE *output, char *outputPath, unsigned int threads){
+    pipeline_t pl;
+    pl.jobs = jobs;
+    pl.count = count;
+    pl.output = output;
+    pl.outputPath = outputPath;
+    pl.depth = threads;
+    pl.nextJob = 0;
+    pl.nextPrefetch = 0;
+    pl.nextWrite = 0;
+    pthread_mutex_init(&(pl.lock), NULL);
+    pthread_cond_init(&(pl.claimed), NULL);
+
+    pthread_t prefetcher;
+    pthread_create(&prefetcher, NULL, prefetchWorker, &pl);
+    pthread_t *workers = (pthread_t *)malloc(threads * sizeof(pthread_t));
+    for(unsigned int i = 1; i < threads; i++) pthread_create(&(workers[i]), NULL, scanWorker, &pl);
+    scanWorker(&pl);
+    for(unsigned int i = 1; i < threads; i++) pthread_join(workers[i], NULL);
+    pthread_join(prefetcher, NULL);
+    free(workers);
+
+    pthread_mutex_destroy(&(pl.lock));
+    pthread_cond_destroy(&(pl.claimed));
 }
 
 
@@ -169,93 +552,77 @@ void KMPMatch(char *text, size_t textLength, char *pattern, size_t patternLength
 // Main Function
 // Takes the path to the "pattern file" as its first argument and the output path
 // to which the statistics table will be written as its second
+// Options: -g writes the source of a pattern-specialized scanner for the pattern file to the output path instead
+//          -j scans the texts pipelined, on the given number of threads
 int main(int argc, char** argv){
     // Verify arguments
-    if(argc != 3){
-        fprintf(stderr, "Usage: stringMatchStats <pattern file path> <output path>\n");
+    bool generate = false;
+    bool valid = true;
+    unsigned int threads = 0;
+    int opt;
+    while((opt = getopt(argc, argv, "gj:")) != -1){
+        switch(opt){
+            case 'g':
+                generate = true;
+                break;
+            case 'j':
+                threads = (unsigned int)atoi(optarg);
+                if(threads < 1){
+                    fprintf(stderr, "Invalid thread count %s\n", optarg);
+                    exit(1);
+                }
+                break;
+            default:
+                valid = false;
+                break;
+        }
+    }
+    if(!valid || argc - optind != 2 || (generate && threads > 0)){
+        fprintf(stderr, "Usage: stringMatchStats [-g | -j threads] <pattern file path> <output path>\n");
         exit(1);
     }
+    char *patternPath = argv[optind];
+    char *outputPath = argv[optind + 1];
 
-    // Open output file for writing
-    FILE *output = fopen(argv[2], "w");
-    if(output == NULL){
-        fprintf(stderr, "Failed to open %s\n", argv[2]);
+    // Open the pattern file and read in its texts and patterns
+    FILE *pf = fopen(patternPath, "r");
+    if(pf == NULL){
+        fprintf(stderr, "Failed to open %s\n", patternPath);
         exit(2);
-    } 
-
-    // Open the pattern file
-    FILE *pf = fopen(argv[1], "r");
-    char pfbuf[PFBUF_SIZE];
-    // Discard the leading hyphen line
-    fgets(pfbuf, PFBUF_SIZE, pf);
-    // Load the text file path into the buffer
-    fgets(pfbuf, PFBUF_SIZE, pf);
+    }
+    scanjob_t *jobs;
+    size_t count = loadPatternFile(pf, &jobs);
+    fclose(pf);
 
-    do {
-        // Strip the trailing newline
-        pfbuf[strlen(pfbuf) - 1] = '\0';
-        
-
-        // Map the text file into memory
-        // 1) Open the file for reading:
-        int fd = open(pfbuf, O_RDONLY);
-        if(fd == -1){
-            fprintf(stderr, "Failed to open %s\n", pfbuf);
-            exit(2);
+    // A scanner with no matchers would not compile, so refuse before the output path is touched
+    if(generate){
+        size_t patterns = 0;
+        for(size_t t = 0; t < count; t++) patterns += jobs[t].count;
+        if(patterns == 0){
+            fprintf(stderr, "No patterns in %s\n", patternPath);
+            exit(3);
         }
-        fprintf(stderr, "File %s open for scanning.\n", pfbuf);
-        fprintf(output, "%s\n", pfbuf);
-
-        // 2) determine file's size:
-        struct stat fileStats;
-        fstat(fd, &fileStats);
-
-        // 3) map file into memory as page(s)
-        char *text = mmap(0, fileStats.st_size, PROT_READ, MAP_SHARED, fd, 0);
-        // Now we may access text as an array; a requirement given by the naive algorithm.
-        // It's Liebig's Law of the Minimum but for computing...
-
-
-         
-        // Now we run line-by-line over the pattern file until we encounter the closing hyphen line
-        while(fgets(pfbuf, PFBUF_SIZE, pf)){
-            if(pfbuf[0] == '-') break;
-
-            // For every pattern
-            size_t patternLength = strlen(pfbuf) - 1;
-            pfbuf[patternLength] = '\0';    // Strip newline
-            fprintf(output, "%s, ", pfbuf);        
-            fprintf(stderr, "\tScanning for '%s'\n", pfbuf);
-
-            // Run Naive Matching
-            naiveMatch(text, (size_t)fileStats.st_size, pfbuf, patternLength, output);
-            fprintf(output, ", ");
+    }
 
-            // Run DFA Matching
-            DFAMatch(text, (size_t)fileStats.st_size, pfbuf, patternLength, output);
-            fprintf(output, ", ");
+    // Open output file for writing
+    FILE *output = fopen(outputPath, "w");
+    if(output == NULL){
+        fprintf(stderr, "Failed to open %s\n", outputPath);
+        exit(2);
+    } 
 
-            // Run KMP Matching
-            KMPMatch(text, (size_t)fileStats.st_size, pfbuf, patternLength, output);
-            fprintf(output, "\n");
+    if(generate){
+        generateScanner(jobs, count, patternPath, output);
+        fprintf(stderr, "Scanner source stored in %s\n", outputPath);
+    } else if(threads > 0){
+        scanPipelined(jobs, count, output, outputPath, threads);
+    } else {
+        for(size_t t = 0; t < count; t++){
+            if(!scanText(&(jobs[t]), output, stderr, outputPath)) exit(2);
         }
+    }
 
-        fprintf(stderr, "Statistics stored in %s\n", argv[2]);
-
-
-        // Unmap and close the text file
-        munmap(text, fileStats.st_size);
-        close(fd);
-
-        // Output some newlines in preparation for next file
-        fprintf(output, "\n\n");
-    
-    // Repeat if there are more texts to be scanned
-    } while (fgets(pfbuf, PFBUF_SIZE, pf));
-        
-
-    // Close the pattern and output files
-    fclose(pf);
+    // Close the output file
     fclose(output);
-
+    freeJobs(jobs, count);
 }
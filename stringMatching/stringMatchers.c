@@ -0,0 +1,171 @@
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "stringMatchers.h"
+
+/* stringMatchers.c
+ *
+ * Written 8 December 2019 by Thomas Pinkava, as part of stringMatchStats.c
+ * The three string matchers, since shared with stringMatchBench
+ */
+
+
+// Naive String Matching
+// All three matching techniques take the text and pattern as input strings and write their resultant statistics
+// directly to the output filestream
+// O(mn) algorithm with zero preprocessing cost
+void naiveMatch(char *text, size_t textLength, char *pattern, size_t patternLength, FILE *output){
+    // Zero statistics and print initial
+    size_t totalCharCompares = 0;
+    bool foundAtLeastOne = false;
+    fprintf(output, "[");
+
+    // For every character in the text at which the pattern would still fit
+    for(size_t i = 0; i + patternLength <= textLength; i++){
+        // Check to see if this character is the start character of the pattern
+        bool match = true;
+        for(size_t j = 0; j < patternLength; j++){
+            totalCharCompares++;
+            if(text[i + j] != pattern[j]){
+                match = false;
+                break;
+            }
+        }
+        if(match){
+            foundAtLeastOne = true;
+            fprintf(output, "%zu, ", i);
+        }
+    }
+
+    fprintf(output, "%s] <0, %zu, %zu>", foundAtLeastOne?"\b\b":"", (textLength > patternLength) ? textLength - patternLength : 0, totalCharCompares);
+}
+
+
+
+
+// Helper for DFA Matching; computes [Pk suffixof PqC]? 
+bool isSuffix(char *p, unsigned int k, unsigned int q, char c){
+    q = q + 1;
+    if(k > q) return false;
+    if(k == 0) return true;
+    char *b = p + (q - k);
+    for(unsigned int i = 0; i < k - 1; i++){
+        if(p[i] != b[i]) return false;
+    }
+    if(p[k - 1] != c){
+        return false;
+    } else {
+        return true;
+    }
+}
+
+
+
+// Computes the transition function of the DFA recognizing the pattern: table[q][c] is the state reached from
+// state q on byte c (for simplicity, the symbol set is all 2^8 byte values; as no pattern holds a '\0', every
+// state goes back to state 0 on one)
+// Returns the preprocessing cost
+unsigned int transitionFunction(char *pattern, size_t patternLength, unsigned int (*table)[256]){
+    unsigned int preprocessingCost = 0;
+    for(unsigned int q = 0; q <= (unsigned int) patternLength; q++){
+        // For every state
+        table[q][0] = 0;
+        for(unsigned char c = 255; c > 0; c--){
+            // For every symbol in symbolset 
+            unsigned int k = ((patternLength + 1) < (q + 2)) ? patternLength + 1: q + 2;
+            while(!isSuffix(pattern, k, q, c)) k--;
+            table[q][c] = k; 
+
+            preprocessingCost += k;
+        }
+    }
+    return preprocessingCost;
+}
+
+
+
+// Deterministic Finite Automaton String Matching
+// Generates a DFA that recognizes the given pattern and uses the given text as its input
+// All three matching techniques take the text and pattern as input strings and write their resultant statistics
+// directly to the output filestream
+// O(n) algorithm with O(m^3 |symbol set|) preprocessing cost
+void DFAMatch(char *text, size_t textLength, char *pattern, size_t patternLength, FILE *output){
+    // Zero statistics and print initial
+    size_t totalCharCompares = 0;
+    size_t totalShifts = 0;
+    unsigned int preprocessingCost = 0;
+    bool foundAtLeastOne = false;
+    fprintf(output, "[");
+
+    // Compute the Automaton's transition table (on the heap, as a long pattern's is too big for the stack)
+    unsigned int (*transitions)[256] = (unsigned int (*)[256])malloc((patternLength + 1) * sizeof(*transitions));
+    preprocessingCost = transitionFunction(pattern, patternLength, transitions);
+
+    // Run the Automaton on the text
+    unsigned int state = 0;
+    for(size_t i = 0; i < textLength; i++){
+        totalCharCompares++;
+        state = transitions[state][(unsigned char)text[i]];
+        if(state == 1) totalShifts++;   // We've bounced back to trying to start a pattern-match here; so add to the total shifts
+        if(state == patternLength){
+            fprintf(output,"%zu, ", i - (patternLength - 1));
+            foundAtLeastOne = true;
+        }
+    }
+    free(transitions);
+
+    fprintf(output, "%s] <%u, %zu, %zu>", foundAtLeastOne?"\b\b":"", preprocessingCost, totalShifts, totalCharCompares);
+}
+
+
+
+
+// Knuth-Morris-Pratt String Matching
+// Isomorphic to DFAMatch but with a streamlined transition function allowing lower preprocessing cost
+// All three matching techniques take the text and pattern as input strings and write their resultant statistics
+// directly to the output filestream
+// O(n) algorithm with O(m) preprocessing cost
+void KMPMatch(char *text, size_t textLength, char *pattern, size_t patternLength, FILE *output){
+    // Zero statistics and print initial
+    size_t totalCharCompares = 0;
+    size_t totalShifts = 0;
+    unsigned int preprocessingCost = 0;
+
+    // Compute the prefix function
+    unsigned int prefixFunction[patternLength];
+    prefixFunction[0] = 0;
+    unsigned int k = 0;
+    for(unsigned int q = 1; q < (unsigned int)patternLength; q++){
+        while(k > 0 && pattern[k] != pattern[q]){
+            k = prefixFunction[k - 1];
+            preprocessingCost++;
+        }
+        if(pattern[k] == pattern[q]) k++;
+        prefixFunction[q] = k;
+        preprocessingCost++;
+    }
+ 
+    // Run the KMP Matcher
+    bool foundAtLeastOne = false;
+    fprintf(output, "[");
+
+    unsigned int q = 0;
+    // For every character in the text
+    for(size_t i = 0; i < textLength; i++){
+        while(q > 0 && pattern[q] != text[i]){
+            q = prefixFunction[q - 1];      
+            totalCharCompares++;
+        }
+        totalCharCompares++;
+        if(pattern[q] == text[i]) q++;
+        if(q == 1) totalShifts++;   // We've bounced back to attempting to match at this position; add one to the total shifts    
+        if(q == patternLength){
+            fprintf(output,"%zu, ", (i + 1) - patternLength);
+            foundAtLeastOne = true;
+            q = prefixFunction[q - 1];    
+        }
+    }
+
+    fprintf(output, "%s] <%u, %zu, %zu>", foundAtLeastOne?"\b\b":"", preprocessingCost, totalShifts, totalCharCompares);
+}
@@ -0,0 +1,35 @@
+#ifndef STRING_MATCHERS_H
+#define STRING_MATCHERS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+/* stringMatchers.h
+ *
+ * The Naive, DFA and KMP string matchers shared by stringMatchStats and
+ * stringMatchBench. Each takes a text (of any bytes) and a pattern (of any
+ * bytes but '\0', and at least one of them) and writes its matching shifts
+ * and statistics to the output filestream as
+ *     [list of matching shifts] <Preprocessing cost, Number of Shifts, Total Character Comparisons>
+ */
+
+
+// O(mn) algorithm with zero preprocessing cost
+void naiveMatch(char *text, size_t textLength, char *pattern, size_t patternLength, FILE *output);
+
+// Helper for DFA Matching; computes [Pk suffixof PqC]?
+bool isSuffix(char *p, unsigned int k, unsigned int q, char c);
+
+// The DFA's transition table: table[q][c] is the state reached from state q on byte c; table has
+// patternLength + 1 rows
+// Returns the preprocessing cost
+unsigned int transitionFunction(char *pattern, size_t patternLength, unsigned int (*table)[256]);
+
+// O(n) algorithm with O(m^3 |symbol set|) preprocessing cost
+void DFAMatch(char *text, size_t textLength, char *pattern, size_t patternLength, FILE *output);
+
+// O(n) algorithm with O(m) preprocessing cost
+void KMPMatch(char *text, size_t textLength, char *pattern, size_t patternLength, FILE *output);
+
+#endif